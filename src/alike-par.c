@@ -0,0 +1,165 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "alike.h"
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ * Parallel pre-check of list elements
+ *
+ * For lists with many elements we can use worker threads to help establish
+ * which elements are alike their template counterparts.  The serial loop in
+ * `ALIKEC_alike_rec` then skips those and runs the full comparison on the
+ * remaining ones, so the first failure, its message, and its recursion index
+ * are exactly what they would be without the pre-check.
+ *
+ * The R API is not thread safe, so the workers limit themselves to the same
+ * simple success cases as compiled templates (see compile.c): same types, same
+ * lengths unless the template length is zero, and attributes that are the
+ * same object or that we can compare without `R_compute_identical`.  To do so
+ * they only read the objects with accessors that neither allocate nor can
+ * error (`TYPEOF`, `ATTRIB`, `CAR`, etc.), and only use `XLENGTH` and
+ * `DATAPTR_RO` once they have established the object is not ALTREP.  Anything
+ * else is left for the serial loop.
+ */
+
+#define ALIKEC_PAR_MAX_DEPTH 64
+
+/*
+ * Non-allocating version of `identical` for attribute values, only handles
+ * attribute-less non-ALTREP atomic vectors, and may return 0 for identical
+ * objects (e.g. different NaN payloads).
+ */
+static int ALIKEC_par_same_val(SEXP tar, SEXP cur) {
+  if(tar == cur) return 1;
+  int type = TYPEOF(tar);
+  if(
+    type != TYPEOF(cur) || ALTREP(tar) || ALTREP(cur) ||
+    ATTRIB(tar) != R_NilValue || ATTRIB(cur) != R_NilValue
+  )
+    return 0;
+
+  size_t size;
+  switch(type) {
+    case LGLSXP: size = sizeof(int); break;
+    case INTSXP: size = sizeof(int); break;
+    case REALSXP: size = sizeof(double); break;
+    case CPLXSXP: size = sizeof(Rcomplex); break;
+    case RAWSXP: size = sizeof(Rbyte); break;
+    // CHARSXPs are cached so pointer equality suffices for the common case
+    case STRSXP: size = sizeof(SEXP); break;
+    default: return 0;
+  }
+  R_xlen_t len = XLENGTH(tar);
+  return len == XLENGTH(cur) && (
+    !len || !memcmp(DATAPTR_RO(tar), DATAPTR_RO(cur), size * (size_t) len)
+  );
+}
+static int ALIKEC_par_attr(SEXP tar_attr, SEXP cur_attr) {
+  for(
+    ;
+    tar_attr != R_NilValue && cur_attr != R_NilValue;
+    tar_attr = CDR(tar_attr), cur_attr = CDR(cur_attr)
+  ) {
+    if(
+      TAG(tar_attr) != TAG(cur_attr) ||
+      !ALIKEC_par_same_val(CAR(tar_attr), CAR(cur_attr))
+    )
+      return 0;
+  }
+  return tar_attr == R_NilValue && cur_attr == R_NilValue;
+}
+/*
+ * Runs in the worker threads, so must not use any R API functions that could
+ * allocate or error.
+ *
+ * @param tar a list element of the template, so NULL is a wildcard
+ * @return 1 if `cur` is alike `tar`, 0 if we need to run the full comparison
+ *   to find out.
+ */
+static int ALIKEC_par_quick(
+  SEXP tar, SEXP cur, struct VALC_settings set, int depth
+) {
+  if(tar == R_NilValue || tar == cur) return 1;
+  if(depth > ALIKEC_PAR_MAX_DEPTH) return 0;
+
+  SEXPTYPE tar_type = TYPEOF(tar), cur_type = TYPEOF(cur);
+  switch(tar_type) {
+    case LGLSXP:
+    case INTSXP:
+    case REALSXP:
+    case CPLXSXP:
+    case STRSXP:
+    case RAWSXP:
+    case VECSXP: break;
+    default: return 0;
+  }
+  if(
+    cur_type != tar_type &&
+    !(tar_type == REALSXP && cur_type == INTSXP && set.type_mode < 2)
+  )
+    return 0;
+  if(
+    ALTREP(tar) || ALTREP(cur) || IS_S4_OBJECT(tar) || IS_S4_OBJECT(cur)
+  )
+    return 0;
+
+  R_xlen_t tar_len = XLENGTH(tar);
+  if(tar_len && tar_len != XLENGTH(cur)) return 0;
+  if(
+    (ATTRIB(tar) != R_NilValue || ATTRIB(cur) != R_NilValue) &&
+    !ALIKEC_par_attr(ATTRIB(tar), ATTRIB(cur))
+  )
+    return 0;
+
+  if(tar_type == VECSXP) {
+    const SEXP * tar_elt = (const SEXP *) DATAPTR_RO(tar);
+    const SEXP * cur_elt = (const SEXP *) DATAPTR_RO(cur);
+    for(R_xlen_t i = 0; i < tar_len; ++i) {
+      if(!ALIKEC_par_quick(tar_elt[i], cur_elt[i], set, depth + 1))
+        return 0;
+  } }
+  return 1;
+}
+/*
+ * Mark which elements of list `current` are known to be alike those of list
+ * `target`, both non-ALTREP and of length at least `len`.
+ *
+ * @return a vector of `len` flags, allocated with R_alloc
+ */
+char * ALIKEC_alike_par(
+  SEXP target, SEXP current, R_xlen_t len, struct VALC_settings set
+) {
+  char * ok = R_alloc((size_t) len, sizeof(char));
+  const SEXP * tar_elt = (const SEXP *) DATAPTR_RO(target);
+  const SEXP * cur_elt = (const SEXP *) DATAPTR_RO(current);
+
+  // Each thread writes its own flags; elements are checked independently so
+  // there is nothing else to synchronize
+
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(set.threads) schedule(dynamic, 1024)
+#endif
+  for(R_xlen_t i = 0; i < len; ++i)
+    ok[i] = (char) ALIKEC_par_quick(tar_elt[i], cur_elt[i], set, 0);
+
+  return ok;
+}
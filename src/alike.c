@@ -47,15 +47,12 @@ SEXP ALIKEC_res_strings_to_SEXP(struct ALIKEC_res_strings strings) {
 /*
  * Other struct initialization functions, see alike.h for descriptions
  *
- * One question here is whether we should create this object once and then
- * re-use it unless an actual error occurs to avoid the R_alloc calls.
+ * These do not allocate, so a comparison that succeeds should not cause any R
+ * heap allocations other than those incurred by the comparisons themselves.
  */
 struct ALIKEC_res_strings ALIKEC_res_strings_init() {
   struct ALIKEC_res_strings res;
 
-  res.target = (const char **) R_alloc(5, sizeof(const char *));
-  res.current = (const char **) R_alloc(5, sizeof(const char *));
-
   res.target[0] = "%s%s%s%s";
   res.target[1] = "";
   res.target[2] = "";
@@ -91,6 +88,13 @@ struct ALIKEC_res ALIKEC_res_init() {
     .wrap=R_NilValue,
   };
 }
+/*
+ * With `fast.fail` the wrap is never used to build a message, so we skip
+ * allocating it, except in attributes where attr.c builds on it.
+ */
+static int ALIKEC_want_wrap(struct VALC_settings set) {
+  return !set.fast_fail || set.in_attr;
+}
 /*-----------------------------------------------------------------------------\
 \-----------------------------------------------------------------------------*/
 
@@ -145,20 +149,9 @@ struct ALIKEC_res ALIKEC_alike_obj(
       }
       const char * klass_c = CHAR(asChar(klass));
 
-      // Construct call to `inherits`; we evaluate in base env since class
-      // definitions should still be visible and this way unlikely that
-      // inherits gets overwritten.  Can't use Rf_inherits because that doesn't
-      // work for S4 classes, and we can't figure out a way to access inherits3
-      // from src/main/objects.c directly
-
-      SEXP t, s;
-      t = s = PROTECT(allocList(3));
-      SET_TYPEOF(s, LANGSXP);
-      SETCAR(t, ALIKEC_SYM_inherits); t = CDR(t);
-      SETCAR(t, current); t = CDR(t);
-      SETCAR(t, klass);
-      int inherits = asLogical(PROTECT(eval(s, R_BaseEnv)));
-      UNPROTECT(2);
+      // See s4-cache.c
+
+      int inherits = ALIKEC_s4_inherits(target, current, klass);
 
       if(!inherits) {
         res.success = 0;
@@ -303,13 +296,14 @@ struct ALIKEC_res ALIKEC_alike_obj(
           res.dat.strings.target[0] = "%s";
           res.dat.strings.cur_pre = "is";
 
-          UNPROTECT(1);
-          res.wrap = PROTECT(allocVector(VECSXP, 2));
-          SEXP len_lang = PROTECT(lang2(ALIKEC_SYM_length, R_NilValue));
-          SET_VECTOR_ELT(res.wrap, 0, len_lang);
-          SET_VECTOR_ELT(res.wrap, 1, CDR(len_lang));
-          UNPROTECT(1);
-        }
+          if(ALIKEC_want_wrap(set)) {
+            UNPROTECT(1);
+            res.wrap = PROTECT(allocVector(VECSXP, 2));
+            SEXP len_lang = PROTECT(lang2(ALIKEC_SYM_length, R_NilValue));
+            SET_VECTOR_ELT(res.wrap, 0, len_lang);
+            SET_VECTOR_ELT(res.wrap, 1, CDR(len_lang));
+            UNPROTECT(1);
+        } }
       } else if (
         res.dat.df && res.dat.lvl > 0 && tar_type == VECSXP &&
         XLENGTH(target) && TYPEOF(current) == VECSXP && XLENGTH(current) &&
@@ -369,7 +363,7 @@ struct ALIKEC_res ALIKEC_alike_obj(
     }
   }
   UNPROTECT(2);
-  if(!res.success && res.wrap == R_NilValue) {
+  if(!res.success && res.wrap == R_NilValue && ALIKEC_want_wrap(set)) {
     res.wrap = allocVector(VECSXP, 2);
   }
   return res;
@@ -379,6 +373,10 @@ Utility functions for updating index lest for error reporting.  General logic
 is to track depth of recursion, and when an error occurs, allocate enough
 space for as many ALIKEC_index structs as there is recursion depth.
 */
+static struct ALIKEC_res ALIKEC_alike_env_vars(
+  SEXP target, SEXP current, SEXP tar_names, struct ALIKEC_rec_track rec,
+  struct VALC_settings set
+);
 /*
 Handle recursive types; these include VECSXP, environments, and pair lists.
 
@@ -404,6 +402,14 @@ struct ALIKEC_res ALIKEC_alike_rec(
   */
   void R_CheckUserInterrupt(void);
 
+  // Plain data frames that are alike can skip the generic logic entirely
+
+  if(ALIKEC_alike_df_fast(target, current, set)) {
+    struct ALIKEC_res res = ALIKEC_res_init();
+    res.dat.rec = rec;
+    res.dat.df = 1;
+    return res;
+  }
   // normal logic, which will have checked length and attributes, etc.
 
   struct ALIKEC_res res = ALIKEC_alike_obj(target, current, set);
@@ -428,14 +434,28 @@ struct ALIKEC_res ALIKEC_alike_rec(
 
     if(tar_type == VECSXP || tar_type == EXPRSXP) {
       R_xlen_t i;
+      char * ok = NULL;
+
+      // For long lists optionally use worker threads to find the elements
+      // that are alike; only the others need the full (serial) comparison
+
+      if(
+        tar_type == VECSXP && set.threads > 1 && !set.in_attr &&
+        tar_len >= set.thread_min_len && !ALTREP(target) && !ALTREP(current)
+      )
+        ok = ALIKEC_alike_par(target, current, tar_len, set);
 
       for(i = 0; i < tar_len; i++) {
+        if(ok && ok[i]) continue;
         // if we're here, there is nothing worth protecting in wrap
+        struct ALIKEC_rec_mark mark = ALIKEC_rec_mark(res.dat.rec);
         res = ALIKEC_alike_rec(
           VECTOR_ELT(target, i), VECTOR_ELT(current, i), res.dat.rec, set
         );
         REPROTECT(res.wrap, ipx);
-        if(!res.success) {
+        if(res.success) {
+          ALIKEC_rec_release(mark, res.dat.rec);
+        } else {
           SEXP vec_names = getAttrib(target, R_NamesSymbol);
           const char * ind_name;
           if(
@@ -474,45 +494,38 @@ struct ALIKEC_res ALIKEC_alike_rec(
         res.success = 1;
       } else {
         if(target == R_GlobalEnv && current != R_GlobalEnv) {
-          REPROTECT(res.wrap = allocVector(VECSXP, 2), ipx);
+          if(ALIKEC_want_wrap(set))
+            REPROTECT(res.wrap = allocVector(VECSXP, 2), ipx);
           res.success = 0;
           res.dat.strings.tar_pre = "be";
           res.dat.strings.target[1] = "the global environment";
           res.dat.strings.current[1] = ""; // gcc-10
         } else {
-          SEXP tar_names = PROTECT(R_lsInternal(target, TRUE));
-          R_xlen_t tar_name_len = XLENGTH(tar_names), i;
+          // Compare in frame order first to avoid sorting the names, which is
+          // expensive for large environments.  Frame order depends on how
+          // the environment was populated, so on failure re-compare in sorted
+          // order so that we always report the same variable (unless we're
+          // not reporting anything with `fast.fail`).  We forget the
+          // environments seen in the first pass, but not `no_rec`, as
+          // otherwise we could warn twice about exhausting the env stack.
+
+          struct ALIKEC_rec_track rec = res.dat.rec;
+          int env_idx = rec.envs->stack_ind;
+          SEXP tar_names = PROTECT(R_lsInternal3(target, TRUE, FALSE));
+
+          res = ALIKEC_alike_env_vars(target, current, tar_names, rec, set);
+          REPROTECT(res.wrap, ipx);
 
-          if(tar_name_len != tar_len) {
-            // nocov start
-            error(
-              "Internal Error: mismatching name-env lengths; contact maintainer"
-            );
-            // nocov end
-          }
-          for(i = 0; i < tar_len; i++) {
-            const char * var_name_chr = CHAR(STRING_ELT(tar_names, i));
-            SEXP var_name = PROTECT(install(var_name_chr));
-            SEXP var_cur_val = PROTECT(findVarInFrame(current, var_name));
-            if(var_cur_val == R_UnboundValue) {
-              REPROTECT(res.wrap = allocVector(VECSXP, 2), ipx);
-              res.success = 0;
-              res.dat.strings.tar_pre = "contain";
-              res.dat.strings.target[0] = "variable `%s`";
-              res.dat.strings.target[1] = var_name_chr;
-              res.dat.strings.current[1] = ""; // gcc-10
-            } else {
-              SEXP var_in_frame = PROTECT(findVarInFrame(target, var_name));
-              res = ALIKEC_alike_rec(
-                var_in_frame, var_cur_val, res.dat.rec, set
-              );
+          if(!res.success && tar_len > 1 && !set.fast_fail) {
+            ALIKEC_env_track_reset(rec.envs, env_idx);
+            SEXP tar_names_sort = PROTECT(R_lsInternal3(target, TRUE, TRUE));
+            struct ALIKEC_res res_sort =
+              ALIKEC_alike_env_vars(target, current, tar_names_sort, rec, set);
+            if(!res_sort.success) {
+              res = res_sort;
               REPROTECT(res.wrap, ipx);
-              UNPROTECT(1);
-              if(!res.success) {
-                res.dat.rec = ALIKEC_rec_ind_chr(res.dat.rec, var_name_chr);
-            } }
-            UNPROTECT(2);
-            if(!res.success) break;
+            }
+            UNPROTECT(1);
           }
           UNPROTECT(1);
         }
@@ -529,7 +542,6 @@ struct ALIKEC_res ALIKEC_alike_rec(
         SEXP tar_tag = TAG(tar_sub);
         SEXP tar_tag_chr = PRINTNAME(tar_tag);
         if(tar_tag != R_NilValue && tar_tag != TAG(cur_sub)) {
-          REPROTECT(res.wrap = allocVector(VECSXP, 2), ipx);
           res.success = 0;
           res.dat.strings.tar_pre = "be";
           res.dat.strings.target[0] =  "\"%s\"%s%s%s";
@@ -549,14 +561,17 @@ struct ALIKEC_res ALIKEC_alike_rec(
               "contact maintainer."
             );
             // nocov end
-          SEXP sub_index = PROTECT(ScalarInteger(i + 1));
-          SEXP sub_sub_lang = PROTECT(lang2(R_NamesSymbol, R_NilValue));
-          SEXP sub_lang = PROTECT(
-            lang3(R_Bracket2Symbol, sub_sub_lang, sub_index)
-          );
-          SET_VECTOR_ELT(res.wrap, 0, sub_lang);
-          SET_VECTOR_ELT(res.wrap, 1, CDR(sub_sub_lang));
-          UNPROTECT(3);
+          if(ALIKEC_want_wrap(set)) {
+            REPROTECT(res.wrap = allocVector(VECSXP, 2), ipx);
+            SEXP sub_index = PROTECT(ScalarInteger(i + 1));
+            SEXP sub_sub_lang = PROTECT(lang2(R_NamesSymbol, R_NilValue));
+            SEXP sub_lang = PROTECT(
+              lang3(R_Bracket2Symbol, sub_sub_lang, sub_index)
+            );
+            SET_VECTOR_ELT(res.wrap, 0, sub_lang);
+            SET_VECTOR_ELT(res.wrap, 1, CDR(sub_sub_lang));
+            UNPROTECT(3);
+          }
           break;
         } else {
           res = ALIKEC_alike_rec(CAR(tar_sub), CAR(cur_sub), res.dat.rec, set);
@@ -575,6 +590,55 @@ struct ALIKEC_res ALIKEC_alike_rec(
   UNPROTECT(1);
   return res;
 }
+/*
+Compare the variables named in `tar_names` in environment `target` to those in
+`current`, stopping at the first failure.
+*/
+static struct ALIKEC_res ALIKEC_alike_env_vars(
+  SEXP target, SEXP current, SEXP tar_names, struct ALIKEC_rec_track rec,
+  struct VALC_settings set
+) {
+  struct ALIKEC_res res = ALIKEC_res_init();
+  res.dat.rec = rec;
+  PROTECT_INDEX ipx;
+  PROTECT_WITH_INDEX(res.wrap, &ipx);
+
+  R_xlen_t tar_len = xlength(target), i;
+  if(XLENGTH(tar_names) != tar_len) {
+    // nocov start
+    error(
+      "Internal Error: mismatching name-env lengths; contact maintainer"
+    );
+    // nocov end
+  }
+  for(i = 0; i < tar_len; i++) {
+    // `installChar` re-uses the hash cached in the CHARSXP
+    SEXP var_name_sxp = STRING_ELT(tar_names, i);
+    const char * var_name_chr = CHAR(var_name_sxp);
+    SEXP var_name = PROTECT(installChar(var_name_sxp));
+    SEXP var_cur_val = PROTECT(findVarInFrame(current, var_name));
+    if(var_cur_val == R_UnboundValue) {
+      if(ALIKEC_want_wrap(set))
+        REPROTECT(res.wrap = allocVector(VECSXP, 2), ipx);
+      res.success = 0;
+      res.dat.strings.tar_pre = "contain";
+      res.dat.strings.target[0] = "variable `%s`";
+      res.dat.strings.target[1] = var_name_chr;
+      res.dat.strings.current[1] = ""; // gcc-10
+    } else {
+      SEXP var_in_frame = PROTECT(findVarInFrame(target, var_name));
+      res = ALIKEC_alike_rec(var_in_frame, var_cur_val, res.dat.rec, set);
+      REPROTECT(res.wrap, ipx);
+      UNPROTECT(1);
+      if(!res.success) {
+        res.dat.rec = ALIKEC_rec_ind_chr(res.dat.rec, var_name_chr);
+    } }
+    UNPROTECT(2);
+    if(!res.success) break;
+  }
+  UNPROTECT(1);
+  return res;
+}
 /*-----------------------------------------------------------------------------\
 \-----------------------------------------------------------------------------*/
 /*
@@ -593,6 +657,11 @@ struct ALIKEC_res ALIKEC_alike_internal(
 
   struct ALIKEC_res res = ALIKEC_res_init();
 
+  // S4 inheritance results are only valid for the duration of a call unless
+  // otherwise requested
+
+  if(!set.in_attr && !set.s4_cache_persist) ALIKEC_s4_cache_reset();
+
   if(TYPEOF(target) == NILSXP && TYPEOF(current) != NILSXP) {
     // Handle NULL special case at top level
 
@@ -600,7 +669,9 @@ struct ALIKEC_res ALIKEC_alike_internal(
     res.dat.strings.target[1] = "`NULL`";
     res.dat.strings.current[0] = "\"%s\"";
     res.dat.strings.current[1] = type2char(TYPEOF(current));
-    res.wrap = PROTECT(allocVector(VECSXP, 2));
+    res.wrap = PROTECT(
+      ALIKEC_want_wrap(set) ? allocVector(VECSXP, 2) : R_NilValue
+    );
   } else {
     // Recursively check object
 
@@ -696,11 +767,61 @@ SEXP ALIKEC_alike_ext(
     // nocov end
   }
   struct VALC_settings set = VALC_settings_vet(settings, env);
-  struct ALIKEC_res res = ALIKEC_alike_internal(target, current, set);
+  struct ALIKEC_res res = ALIKEC_alike_tpl(target, current, set);
   PROTECT(res.wrap);
   SEXP res_sxp;
-  if(res.success) res_sxp = PROTECT(ScalarLogical(1));
+  if(res.success || set.fast_fail)
+    res_sxp = PROTECT(ScalarLogical(res.success));
   else res_sxp = PROTECT(ALIKEC_res_as_string(res, curr_sub, set));
   UNPROTECT(2);
   return res_sxp;
 }
+/*
+Compare each element of list `current` to `target`
+
+Settings are vetted once for all the elements, and the error messages, which
+are by far the most expensive part of a failure, are only generated for the
+elements that fail, with the call `curr_sub[[i]]`.
+*/
+SEXP ALIKEC_alike_each_ext(
+  SEXP target, SEXP current, SEXP curr_sub, SEXP env, SEXP settings
+) {
+  if(TYPEOF(current) != VECSXP)
+    error(
+      "Argument `current` must be a list (is %s).",
+      type2char(TYPEOF(current))
+    );
+  if(TYPEOF(curr_sub) != LANGSXP && TYPEOF(curr_sub) != SYMSXP)
+    curr_sub = ALIKEC_SYM_current;
+
+  struct VALC_settings set = VALC_settings_vet(settings, env);
+  R_xlen_t cur_len = XLENGTH(current);
+  SEXP res_sxp = PROTECT(allocVector(VECSXP, cur_len));
+  SEXP res_true = PROTECT(ScalarLogical(1));
+  SEXP res_false = PROTECT(ScalarLogical(0));
+
+  for(R_xlen_t i = 0; i < cur_len; ++i) {
+    // Each result is fully converted to SEXP, so release scratch memory
+    // between elements
+    const void * vmax = vmaxget();
+    struct ALIKEC_res res =
+      ALIKEC_alike_tpl(target, VECTOR_ELT(current, i), set);
+    PROTECT(res.wrap);
+    if(res.success || set.fast_fail) {
+      SET_VECTOR_ELT(res_sxp, i, res.success ? res_true : res_false);
+    } else {
+      SEXP curr_sub_i = PROTECT(
+        lang3(R_Bracket2Symbol, curr_sub, PROTECT(ScalarReal((double) i + 1)))
+      );
+      SET_VECTOR_ELT(
+        res_sxp, i, ALIKEC_res_as_string(res, curr_sub_i, set)
+      );
+      UNPROTECT(2);
+    }
+    UNPROTECT(1);
+    vmaxset(vmax);
+  }
+  setAttrib(res_sxp, R_NamesSymbol, getAttrib(current, R_NamesSymbol));
+  UNPROTECT(3);
+  return res_sxp;
+}
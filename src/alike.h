@@ -17,7 +17,8 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 */
 
 #include "cstringr.h"
-#include "pfhash.h"
+#include "ptrhash.h"
+#include "trackinghash.h"
 #include "settings.h"
 #include <wchar.h>
 
@@ -55,12 +56,13 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
    * For legacy reasons, we didn't collapse the _pre strings into the array
    */
   struct ALIKEC_res_strings {
-    // format string, must have 4 %s, followed by four other strings, these
-    // are supposed to be initialized to 5 long arrays; don't initialize them as
-    // actual arrays as they can't be modified.
+    // format string, must have 4 %s, followed by four other strings.  These
+    // are inline arrays rather than R_alloc'ed ones so that initializing a
+    // result (which we do for every node, attribute, etc. compared) does not
+    // allocate.  Note this means copies of the struct do not share the arrays.
 
-    const char ** target;
-    const char ** current;
+    const char * target[5];
+    const char * current[5];
 
     const char * tar_pre;    // be, have, etc.
     const char * cur_pre;    // is, has, etc.
@@ -69,9 +71,9 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   // infinite recursion loop
 
   struct ALIKEC_env_track {
-    SEXP * env_stack;
-    int stack_size;
-    int stack_ind;
+    struct track_hash * env_hash;  // environments seen so far
+    int stack_size;   // how many environments we have room for
+    int stack_ind;    // how many environments we've seen
     int stack_size_init;
     int no_rec;       // prevent further recursion into environments
     int debug;
@@ -86,6 +88,14 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
     size_t lvl_max;    // max recursion depth so far
     int gp;            // general purpose flag
   };
+  // R_alloc stack position prior to a sub-comparison, see ALIKEC_rec_mark
+
+  struct ALIKEC_rec_mark {
+    const void * vmax;
+    struct ALIKEC_env_track * envs;
+    const void ** env_keys;
+    const void ** env_log;
+  };
   struct ALIKEC_res_dat {
     struct ALIKEC_rec_track rec;
     struct ALIKEC_res_strings strings;
@@ -141,6 +151,22 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   SEXP ALIKEC_alike_ext(
     SEXP target, SEXP current, SEXP cur_sub, SEXP env, SEXP settings
   );
+  SEXP ALIKEC_alike_each_ext(
+    SEXP target, SEXP current, SEXP cur_sub, SEXP env, SEXP settings
+  );
+  SEXP ALIKEC_compile_template(SEXP target);
+  int ALIKEC_s4_inherits(SEXP target, SEXP current, SEXP klass);
+  void ALIKEC_s4_cache_reset();
+  char * ALIKEC_alike_par(
+    SEXP target, SEXP current, R_xlen_t len, struct VALC_settings set
+  );
+  int ALIKEC_is_compiled(SEXP x);
+  int ALIKEC_alike_df_fast(
+    SEXP target, SEXP current, struct VALC_settings set
+  );
+  struct ALIKEC_res ALIKEC_alike_tpl(
+    SEXP target, SEXP current, struct VALC_settings set
+  );
   struct ALIKEC_res ALIKEC_alike_internal(
     SEXP target, SEXP current, struct VALC_settings set
   );
@@ -155,6 +181,7 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   );
   SEXP ALIKEC_compare_attributes(SEXP target, SEXP current, SEXP attr_mode);
   SEXP ALIKEC_compare_special_char_attrs(SEXP target, SEXP current);
+  int ALIKEC_row_names_compact_alike(SEXP target, SEXP current);
   struct ALIKEC_res ALIKEC_compare_attributes_internal(
     SEXP target, SEXP current, struct VALC_settings set
   );
@@ -167,8 +194,10 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   SEXP ALIKEC_lang_alike_ext(SEXP target, SEXP current, SEXP match_env);
   SEXP ALIKEC_lang_alike_chr_ext(SEXP target, SEXP current, SEXP match_env);
   struct ALIKEC_res ALIKEC_lang_alike_rec(
-    SEXP target, SEXP cur_par, pfHashTable * tar_hash, pfHashTable * cur_hash,
-    pfHashTable * rev_hash, size_t * tar_varnum, size_t * cur_varnum,
+    SEXP target, SEXP current, SEXP cur_par, struct VALC_ptr_hash * tar_hash,
+    struct VALC_ptr_hash * cur_hash, struct VALC_ptr_hash * rev_hash,
+    struct VALC_ptr_hash * fun_hash, SEXP fun_prot,
+    size_t * tar_varnum, size_t * cur_varnum,
     int formula, SEXP match_call, SEXP match_env, struct VALC_settings set,
     struct ALIKEC_rec_track rec
   );
@@ -211,6 +240,7 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   );
   SEXP ALIKEC_deparse_width(SEXP obj, int width);
   SEXP ALIKEC_deparse(SEXP obj, int width_cutoff);
+  SEXP ALIKEC_deparse_fast(SEXP obj, int width_cutoff);
   const char * ALIKEC_pad(
     SEXP obj, R_xlen_t lines, int pad, struct VALC_settings set
   );
@@ -220,6 +250,9 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   );
   SEXP ALIKEC_inject_call(struct ALIKEC_res res, SEXP call);
   SEXP ALIKEC_match_call(SEXP call, SEXP match_call, SEXP env);
+  SEXP ALIKEC_match_call_fast(SEXP call, SEXP fun);
+  SEXP ALIKEC_match_call_cache_get(SEXP call, SEXP fun);
+  void ALIKEC_match_call_cache_set(SEXP call, SEXP fun, SEXP matched);
   SEXP ALIKEC_findFun(SEXP symbol, SEXP rho);
   SEXP ALIKEC_findFun_ext(SEXP symbol, SEXP rho);
   struct ALIKEC_res ALIKEC_res_init();
@@ -232,6 +265,7 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   SEXP ALIKEC_class(SEXP obj, SEXP class);
   SEXP ALIKEC_abstract_ts(SEXP x, SEXP what);
   int ALIKEC_env_track(SEXP env, struct ALIKEC_env_track * envs, int env_limit);
+  void ALIKEC_env_track_reset(struct ALIKEC_env_track * envs, int idx);
   SEXP ALIKEC_env_track_test(SEXP env, SEXP stack_size_init, SEXP env_limit);
   struct ALIKEC_env_track * ALIKEC_env_set_create(
     int stack_size_init, int env_limit
@@ -243,6 +277,10 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   SEXP ALIKEC_is_dfish_ext(SEXP obj);
   struct ALIKEC_rec_track ALIKEC_rec_inc(struct ALIKEC_rec_track);
   struct ALIKEC_rec_track ALIKEC_rec_dec(struct ALIKEC_rec_track);
+  struct ALIKEC_rec_mark ALIKEC_rec_mark(struct ALIKEC_rec_track rec);
+  void ALIKEC_rec_release(
+    struct ALIKEC_rec_mark mark, struct ALIKEC_rec_track rec
+  );
   SEXP ALIKEC_syntactic_names_exp(SEXP lang);
   SEXP ALIKEC_sort_msg(SEXP msgs, struct VALC_settings set);
   SEXP ALIKEC_sort_msg_ext(SEXP msgs);
@@ -276,4 +314,5 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   extern SEXP ALIKEC_SYM_colnames;
   extern SEXP ALIKEC_SYM_length;
   extern SEXP ALIKEC_SYM_syntacticnames;
+  extern SEXP ALIKEC_SYM_template;
 #endif
@@ -0,0 +1,507 @@
+#include "all-bw.h"
+
+/*
+ * SIMD versions of the numeric `all_bw` loops.
+ *
+ * The scalar loops in all-bw.c `break` on the first failure, and that data
+ * dependent branch prevents the compiler from vectorizing them.  Here we
+ * compare whole blocks of elements, AND the "in bounds" masks of the block
+ * together, and only if the block contains a failure do we go back to scalar
+ * code to find the exact index of the first failure within the block.
+ *
+ * All x86_64 CPUs support SSE2, and we pick AVX2 at run time if the CPU
+ * supports it.  If the compiler does not support the intrinsics / target
+ * attributes or we're not on x86 the functions here just return -1 and the
+ * scalar loops in all-bw.c are used.
+ *
+ * To limit the number of variations we normalize all comparisons:
+ *
+ * - Doubles: exclusive bounds are turned into inclusive ones with `nextafter`,
+ *   which is exact since there is no representable double between `lo` and
+ *   `nextafter(lo, Inf)`.  Unbounded ends are just -Inf/Inf inclusive, which
+ *   only NaNs fail.  Exclusive infinite ends that would not move with
+ *   `nextafter` are set to NaN so that everything fails the comparison, as it
+ *   should (e.g. `x > Inf`).
+ * - Integers: SSE2 only has "greater than", so we use `x > lo_x` and
+ *   `!(x > hi_x)` with `lo_x` and `hi_x` the exclusive versions of the bounds.
+ *   Since `lo` is at least `INT_MIN + 1`, NA_INTEGER (INT_MIN) always fails
+ *   the lower bound check unless `na_rm`.
+ *
+ * The kernels do not use the R API so they are safe to call from other threads,
+ * which we do for very long vectors if `vetr` was compiled with OpenMP and the
+ * `threads` setting is greater than one (see `VALC_all_bw_real_par`).
+ */
+
+#if defined(__GNUC__) && defined(__SSE2__) && \
+  (defined(__x86_64__) || defined(__i386__))
+#define VALC_ALLBW_SIMD 1
+#include <immintrin.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Scalar versions of the normalized checks, used for the tail of the vectors
+// and to find the first failure in a failing block
+
+static inline int real_ok(double x, double lo, double hi, int na_rm) {
+  return (x >= lo && x <= hi) || (na_rm && ISNAN(x));
+}
+static inline int int_ok(int x, int lo_x, int hi_x, int na_rm) {
+  return (x > lo_x && !(x > hi_x)) || (na_rm && x == NA_INTEGER);
+}
+static R_xlen_t real_scalar(
+  const double * x, R_xlen_t start, R_xlen_t end, double lo, double hi,
+  int na_rm
+) {
+  for(R_xlen_t i = start; i < end; ++i)
+    if(!real_ok(x[i], lo, hi, na_rm)) return i;
+  return end;
+}
+static R_xlen_t int_scalar(
+  const int * x, R_xlen_t start, R_xlen_t end, int lo_x, int hi_x, int na_rm
+) {
+  for(R_xlen_t i = start; i < end; ++i)
+    if(!int_ok(x[i], lo_x, hi_x, na_rm)) return i;
+  return end;
+}
+#ifdef VALC_ALLBW_SIMD
+
+// Must be called before any threads are started
+
+static int VALC_has_avx2 = -1;
+
+static int has_avx2() {
+  if(VALC_has_avx2 < 0) {
+    __builtin_cpu_init();
+    VALC_has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return VALC_has_avx2;
+}
+// - Doubles -------------------------------------------------------------------
+
+static R_xlen_t real_sse2(
+  const double * x, R_xlen_t start, R_xlen_t end, double lo, double hi,
+  int na_rm
+) {
+  const __m128d lo_v = _mm_set1_pd(lo);
+  const __m128d hi_v = _mm_set1_pd(hi);
+  const __m128d na_v = _mm_castsi128_pd(_mm_set1_epi64x(na_rm ? -1 : 0));
+  R_xlen_t i = start;
+
+  // Blocks of 4 vectors x 2 doubles
+
+  for(; end - i >= 8; i += 8) {
+    __m128d ok = _mm_castsi128_pd(_mm_set1_epi64x(-1));
+    for(int j = 0; j < 8; j += 2) {
+      __m128d v = _mm_loadu_pd(x + i + j);
+      __m128d in = _mm_and_pd(_mm_cmpge_pd(v, lo_v), _mm_cmple_pd(v, hi_v));
+      in = _mm_or_pd(in, _mm_and_pd(_mm_cmpunord_pd(v, v), na_v));
+      ok = _mm_and_pd(ok, in);
+    }
+    if(_mm_movemask_pd(ok) != 0x3) {
+      R_xlen_t fail = real_scalar(x, i, i + 8, lo, hi, na_rm);
+      if(fail < i + 8) return fail;
+  } }
+  return real_scalar(x, i, end, lo, hi, na_rm);
+}
+__attribute__((target("avx2")))
+static R_xlen_t real_avx2(
+  const double * x, R_xlen_t start, R_xlen_t end, double lo, double hi,
+  int na_rm
+) {
+  const __m256d lo_v = _mm256_set1_pd(lo);
+  const __m256d hi_v = _mm256_set1_pd(hi);
+  const __m256d na_v =
+    _mm256_castsi256_pd(_mm256_set1_epi64x(na_rm ? -1 : 0));
+  R_xlen_t i = start;
+
+  // Blocks of 4 vectors x 4 doubles
+
+  for(; end - i >= 16; i += 16) {
+    __m256d ok = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for(int j = 0; j < 16; j += 4) {
+      __m256d v = _mm256_loadu_pd(x + i + j);
+      __m256d in = _mm256_and_pd(
+        _mm256_cmp_pd(v, lo_v, _CMP_GE_OQ), _mm256_cmp_pd(v, hi_v, _CMP_LE_OQ)
+      );
+      in = _mm256_or_pd(
+        in, _mm256_and_pd(_mm256_cmp_pd(v, v, _CMP_UNORD_Q), na_v)
+      );
+      ok = _mm256_and_pd(ok, in);
+    }
+    if(_mm256_movemask_pd(ok) != 0xF) {
+      R_xlen_t fail = real_scalar(x, i, i + 16, lo, hi, na_rm);
+      if(fail < i + 16) return fail;
+  } }
+  return real_scalar(x, i, end, lo, hi, na_rm);
+}
+// - Integers ------------------------------------------------------------------
+
+static R_xlen_t int_sse2(
+  const int * x, R_xlen_t start, R_xlen_t end, int lo_x, int hi_x, int na_rm
+) {
+  const __m128i lo_v = _mm_set1_epi32(lo_x);
+  const __m128i hi_v = _mm_set1_epi32(hi_x);
+  const __m128i na_v = _mm_set1_epi32(NA_INTEGER);
+  const __m128i na_rm_v = _mm_set1_epi32(na_rm ? -1 : 0);
+  R_xlen_t i = start;
+
+  // Blocks of 4 vectors x 4 ints
+
+  for(; end - i >= 16; i += 16) {
+    __m128i ok = _mm_set1_epi32(-1);
+    for(int j = 0; j < 16; j += 4) {
+      __m128i v = _mm_loadu_si128((const __m128i *) (x + i + j));
+      __m128i in =
+        _mm_andnot_si128(_mm_cmpgt_epi32(v, hi_v), _mm_cmpgt_epi32(v, lo_v));
+      in = _mm_or_si128(in, _mm_and_si128(_mm_cmpeq_epi32(v, na_v), na_rm_v));
+      ok = _mm_and_si128(ok, in);
+    }
+    if(_mm_movemask_epi8(ok) != 0xFFFF) {
+      R_xlen_t fail = int_scalar(x, i, i + 16, lo_x, hi_x, na_rm);
+      if(fail < i + 16) return fail;
+  } }
+  return int_scalar(x, i, end, lo_x, hi_x, na_rm);
+}
+__attribute__((target("avx2")))
+static R_xlen_t int_avx2(
+  const int * x, R_xlen_t start, R_xlen_t end, int lo_x, int hi_x, int na_rm
+) {
+  const __m256i lo_v = _mm256_set1_epi32(lo_x);
+  const __m256i hi_v = _mm256_set1_epi32(hi_x);
+  const __m256i na_v = _mm256_set1_epi32(NA_INTEGER);
+  const __m256i na_rm_v = _mm256_set1_epi32(na_rm ? -1 : 0);
+  R_xlen_t i = start;
+
+  // Blocks of 2 vectors x 8 ints
+
+  for(; end - i >= 16; i += 16) {
+    __m256i ok = _mm256_set1_epi32(-1);
+    for(int j = 0; j < 16; j += 8) {
+      __m256i v = _mm256_loadu_si256((const __m256i *) (x + i + j));
+      __m256i in = _mm256_andnot_si256(
+        _mm256_cmpgt_epi32(v, hi_v), _mm256_cmpgt_epi32(v, lo_v)
+      );
+      in = _mm256_or_si256(
+        in, _mm256_and_si256(_mm256_cmpeq_epi32(v, na_v), na_rm_v)
+      );
+      ok = _mm256_and_si256(ok, in);
+    }
+    if(_mm256_movemask_epi8(ok) != -1) {
+      R_xlen_t fail = int_scalar(x, i, i + 16, lo_x, hi_x, na_rm);
+      if(fail < i + 16) return fail;
+  } }
+  return int_scalar(x, i, end, lo_x, hi_x, na_rm);
+}
+#endif
+/*
+ * Normalize bounds as described at top of file
+ */
+static void real_norm(double * lo, double * hi, int inc_lo, int inc_hi) {
+  if(!inc_lo) *lo = *lo == R_PosInf ? R_NaN : nextafter(*lo, R_PosInf);
+  if(!inc_hi) *hi = *hi == R_NegInf ? R_NaN : nextafter(*hi, R_NegInf);
+}
+static void int_norm(int * lo, int * hi, int inc_lo, int inc_hi) {
+  if(inc_lo) *lo = *lo - 1;
+  if(!inc_hi) *hi = *hi - 1;
+}
+// Best kernel available; bounds must already be normalized
+
+static R_xlen_t real_kernel(
+  const double * x, R_xlen_t start, R_xlen_t end, double lo, double hi,
+  int na_rm
+) {
+#ifdef VALC_ALLBW_SIMD
+  if(has_avx2()) return real_avx2(x, start, end, lo, hi, na_rm);
+  return real_sse2(x, start, end, lo, hi, na_rm);
+#else
+  return real_scalar(x, start, end, lo, hi, na_rm);
+#endif
+}
+static R_xlen_t int_kernel(
+  const int * x, R_xlen_t start, R_xlen_t end, int lo_x, int hi_x, int na_rm
+) {
+#ifdef VALC_ALLBW_SIMD
+  if(has_avx2()) return int_avx2(x, start, end, lo_x, hi_x, na_rm);
+  return int_sse2(x, start, end, lo_x, hi_x, na_rm);
+#else
+  return int_scalar(x, start, end, lo_x, hi_x, na_rm);
+#endif
+}
+/*
+ * Find first element of `x[start:end)` out of bounds
+ *
+ * Bounds are as computed by VALC_all_bw for the double case, so `lo`/`hi` can
+ * be infinite, but not NA.
+ *
+ * @return index of the first failing element, `end` if none fail, or -1 if
+ *   SIMD is not available and the caller should use the scalar loops.
+ */
+R_xlen_t VALC_all_bw_real_simd(
+  const double * x, R_xlen_t start, R_xlen_t end, double lo, double hi,
+  int inc_lo, int inc_hi, int na_rm
+) {
+#ifdef VALC_ALLBW_SIMD
+  real_norm(&lo, &hi, inc_lo, inc_hi);
+  return real_kernel(x, start, end, lo, hi, na_rm);
+#else
+  return -1;
+#endif
+}
+/*
+ * Integer version of `VALC_all_bw_real_simd`, `lo` and `hi` are the integer
+ * bounds computed by VALC_all_bw, so `lo` is at least `INT_MIN + 1`.
+ */
+R_xlen_t VALC_all_bw_int_simd(
+  const int * x, R_xlen_t start, R_xlen_t end, int lo, int hi,
+  int inc_lo, int inc_hi, int na_rm
+) {
+#ifdef VALC_ALLBW_SIMD
+  int_norm(&lo, &hi, inc_lo, inc_hi);
+  return int_kernel(x, start, end, lo, hi, na_rm);
+#else
+  return -1;
+#endif
+}
+/*
+ * Multi-threaded versions
+ *
+ * The vector is split into blocks that are distributed in contiguous runs to
+ * each thread.  Threads share the lowest failing index found so far, and skip
+ * any block that starts after it, so that once a failure is found the threads
+ * working on later parts of the vector stop early.  Since each thread scans its
+ * blocks in order, and only skips blocks that are after a known failure, the
+ * final value is the lowest failing index, same as with the serial version.
+ *
+ * Unlike the `_simd` functions these always return a result (i.e. never -1),
+ * using the scalar kernels if SIMD is not available, and a single thread if
+ * OpenMP is not available.
+ */
+#define VALC_ALLBW_BLOCK 65536
+
+R_xlen_t VALC_all_bw_real_par(
+  const double * x, R_xlen_t len, double lo, double hi,
+  int inc_lo, int inc_hi, int na_rm, int threads
+) {
+  real_norm(&lo, &hi, inc_lo, inc_hi);
+  R_xlen_t fail = len;
+#ifdef VALC_ALLBW_SIMD
+  has_avx2();
+#endif
+#ifdef _OPENMP
+  R_xlen_t blocks = (len - 1) / VALC_ALLBW_BLOCK + 1;
+
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for(R_xlen_t b = 0; b < blocks; ++b) {
+    R_xlen_t start = b * VALC_ALLBW_BLOCK;
+    R_xlen_t end = len - start > VALC_ALLBW_BLOCK ?
+      start + VALC_ALLBW_BLOCK : len;
+    R_xlen_t fail_cur;
+    #pragma omp atomic read
+    fail_cur = fail;
+    if(fail_cur < start) continue;
+
+    R_xlen_t res = real_kernel(x, start, end, lo, hi, na_rm);
+    if(res < end) {
+      // Writers are serialized by the critical section, but readers above
+      // are not, so the store must be atomic too.
+      #pragma omp critical(VALC_all_bw_fail)
+      if(res < fail) {
+        #pragma omp atomic write
+        fail = res;
+  } } }
+#else
+  fail = real_kernel(x, 0, len, lo, hi, na_rm);
+#endif
+  return fail;
+}
+R_xlen_t VALC_all_bw_int_par(
+  const int * x, R_xlen_t len, int lo, int hi,
+  int inc_lo, int inc_hi, int na_rm, int threads
+) {
+  int_norm(&lo, &hi, inc_lo, inc_hi);
+  R_xlen_t fail = len;
+#ifdef VALC_ALLBW_SIMD
+  has_avx2();
+#endif
+#ifdef _OPENMP
+  R_xlen_t blocks = (len - 1) / VALC_ALLBW_BLOCK + 1;
+
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for(R_xlen_t b = 0; b < blocks; ++b) {
+    R_xlen_t start = b * VALC_ALLBW_BLOCK;
+    R_xlen_t end = len - start > VALC_ALLBW_BLOCK ?
+      start + VALC_ALLBW_BLOCK : len;
+    R_xlen_t fail_cur;
+    #pragma omp atomic read
+    fail_cur = fail;
+    if(fail_cur < start) continue;
+
+    R_xlen_t res = int_kernel(x, start, end, lo, hi, na_rm);
+    if(res < end) {
+      #pragma omp critical(VALC_all_bw_fail)
+      if(res < fail) {
+        #pragma omp atomic write
+        fail = res;
+  } } }
+#else
+  fail = int_kernel(x, 0, len, lo, hi, na_rm);
+#endif
+  return fail;
+}
+/*
+ * ALTREP versions
+ *
+ * `REAL`/`INTEGER` force ALTREP vectors (compact sequences, memory mapped
+ * files, etc.) to allocate and fill a data pointer.  Instead, for ALTREP
+ * vectors that don't already have one we copy fixed size regions into a
+ * buffer with `*_GET_REGION` and run the kernels on that.  Vectors known to
+ * be sorted and free of NAs only need their first and last elements checked.
+ *
+ * These use the R API so must be called from the main thread.
+ *
+ * @return as `VALC_all_bw_real_par`, or -1 if `x` is not an ALTREP vector
+ *   without a data pointer, in which case the caller should use `REAL(x)`.
+ */
+#define VALC_ALLBW_REGION 4096
+
+R_xlen_t VALC_all_bw_real_altrep(
+  SEXP x, R_xlen_t len, double lo, double hi, int inc_lo, int inc_hi,
+  int na_rm
+) {
+  if(!ALTREP(x) || DATAPTR_OR_NULL(x)) return -1;
+  real_norm(&lo, &hi, inc_lo, inc_hi);
+  if(!len) return 0;
+
+  if(
+    KNOWN_SORTED(REAL_IS_SORTED(x)) && REAL_NO_NA(x) &&
+    real_ok(REAL_ELT(x, 0), lo, hi, 0) &&
+    real_ok(REAL_ELT(x, len - 1), lo, hi, 0)
+  )
+    return len;
+
+  double buf[VALC_ALLBW_REGION];
+  for(R_xlen_t start = 0; start < len; start += VALC_ALLBW_REGION) {
+    R_xlen_t n = REAL_GET_REGION(x, start, VALC_ALLBW_REGION, buf);
+    R_xlen_t res = real_kernel(buf, 0, n, lo, hi, na_rm);
+    if(res < n) return start + res;
+  }
+  return len;
+}
+/*
+ * Also handles logical vectors, which have no sortedness metadata.
+ */
+R_xlen_t VALC_all_bw_int_altrep(
+  SEXP x, R_xlen_t len, int lo, int hi, int inc_lo, int inc_hi, int na_rm
+) {
+  if(!ALTREP(x) || DATAPTR_OR_NULL(x)) return -1;
+  int_norm(&lo, &hi, inc_lo, inc_hi);
+  if(!len) return 0;
+
+  int is_int = TYPEOF(x) == INTSXP;
+  if(
+    is_int && KNOWN_SORTED(INTEGER_IS_SORTED(x)) && INTEGER_NO_NA(x) &&
+    int_ok(INTEGER_ELT(x, 0), lo, hi, 0) &&
+    int_ok(INTEGER_ELT(x, len - 1), lo, hi, 0)
+  )
+    return len;
+
+  int buf[VALC_ALLBW_REGION];
+  for(R_xlen_t start = 0; start < len; start += VALC_ALLBW_REGION) {
+    R_xlen_t n = is_int ?
+      INTEGER_GET_REGION(x, start, VALC_ALLBW_REGION, buf) :
+      LOGICAL_GET_REGION(x, start, VALC_ALLBW_REGION, buf);
+    R_xlen_t res = int_kernel(buf, 0, n, lo, hi, na_rm);
+    if(res < n) return start + res;
+  }
+  return len;
+}
+// - Integer likeness ----------------------------------------------------------
+
+/*
+ * A double is integer-like if it survives the round trip through `int`
+ * unchanged, which excludes NaN, infinite and out of range values.  We check
+ * the range explicitly in the scalar version since the conversion is undefined
+ * for out of range values in C.  The SIMD truncating conversions return
+ * INT_MIN for those, which is only equal to the original for -2^31 itself, and
+ * that is in range.
+ */
+static inline int intlike_ok(double x) {
+  return x >= -2147483648.0 && x < 2147483648.0 && x == (double) (int) x;
+}
+static R_xlen_t intlike_scalar(
+  const double * x, R_xlen_t start, R_xlen_t end
+) {
+  for(R_xlen_t i = start; i < end; ++i) if(!intlike_ok(x[i])) return i;
+  return end;
+}
+#ifdef VALC_ALLBW_SIMD
+
+static R_xlen_t intlike_sse2(const double * x, R_xlen_t start, R_xlen_t end) {
+  R_xlen_t i = start;
+
+  // Blocks of 4 vectors x 2 doubles
+
+  for(; end - i >= 8; i += 8) {
+    __m128d ok = _mm_castsi128_pd(_mm_set1_epi64x(-1));
+    for(int j = 0; j < 8; j += 2) {
+      __m128d v = _mm_loadu_pd(x + i + j);
+      __m128d v_int = _mm_cvtepi32_pd(_mm_cvttpd_epi32(v));
+      ok = _mm_and_pd(ok, _mm_cmpeq_pd(v, v_int));
+    }
+    if(_mm_movemask_pd(ok) != 0x3) {
+      R_xlen_t fail = intlike_scalar(x, i, i + 8);
+      if(fail < i + 8) return fail;
+  } }
+  return intlike_scalar(x, i, end);
+}
+__attribute__((target("avx2")))
+static R_xlen_t intlike_avx2(const double * x, R_xlen_t start, R_xlen_t end) {
+  R_xlen_t i = start;
+
+  // Blocks of 4 vectors x 4 doubles
+
+  for(; end - i >= 16; i += 16) {
+    __m256d ok = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for(int j = 0; j < 16; j += 4) {
+      __m256d v = _mm256_loadu_pd(x + i + j);
+      __m256d v_int = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(v));
+      ok = _mm256_and_pd(ok, _mm256_cmp_pd(v, v_int, _CMP_EQ_OQ));
+    }
+    if(_mm256_movemask_pd(ok) != 0xF) {
+      R_xlen_t fail = intlike_scalar(x, i, i + 16);
+      if(fail < i + 16) return fail;
+  } }
+  return intlike_scalar(x, i, end);
+}
+#endif
+static R_xlen_t intlike_kernel(
+  const double * x, R_xlen_t start, R_xlen_t end
+) {
+#ifdef VALC_ALLBW_SIMD
+  if(has_avx2()) return intlike_avx2(x, start, end);
+  return intlike_sse2(x, start, end);
+#else
+  return intlike_scalar(x, start, end);
+#endif
+}
+/*
+ * Whether all elements of double vector `x` are integer-like
+ *
+ * ALTREP vectors without a data pointer are read in regions so that they are
+ * not materialized.
+ */
+int VALC_all_int_like(SEXP x) {
+  R_xlen_t len = XLENGTH(x);
+  const double * x_ptr = (const double *) DATAPTR_OR_NULL(x);
+  if(x_ptr) return intlike_kernel(x_ptr, 0, len) == len;
+
+  double buf[VALC_ALLBW_REGION];
+  for(R_xlen_t start = 0; start < len; start += VALC_ALLBW_REGION) {
+    R_xlen_t n = REAL_GET_REGION(x, start, VALC_ALLBW_REGION, buf);
+    if(intlike_kernel(buf, 0, n) < n) return 0;
+  }
+  return 1;
+}
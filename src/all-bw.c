@@ -34,8 +34,9 @@ static void include_end_err() {
  * See R interface fun for docs
  */
 SEXP VALC_all_bw(
-  SEXP x, SEXP lo, SEXP hi, SEXP na_rm, SEXP include_bounds
+  SEXP x, SEXP lo, SEXP hi, SEXP na_rm, SEXP include_bounds, SEXP settings
 ) {
+  struct VALC_settings set = VALC_settings_vet(settings, R_BaseEnv);
   SEXPTYPE x_type = TYPEOF(x), lo_type = TYPEOF(lo), hi_type = TYPEOF(hi);
 
   int int_min = INT_MIN + 1;
@@ -194,9 +195,34 @@ SEXP VALC_all_bw(
     if(x_type == REALSXP) {
       // - Numeric -------------------------------------------------------------
 
-      double * data = REAL(x);
-
-      if(!lo_unbound && !hi_unbound) {
+      double * data = NULL;
+
+      // Use SIMD version if available (see all-bw-simd.c), otherwise fall back
+      // to the scalar loops.  Very long vectors may be split across threads.
+      // ALTREP vectors are checked without materializing them.
+
+      R_xlen_t simd_i = -1;
+      if(!(lo_unbound && hi_unbound && na_rm_int)) {
+        simd_i = VALC_all_bw_real_altrep(
+          x, x_len, lo_num, hi_num, inc_lo, inc_hi, na_rm_int
+        );
+        if(simd_i < 0) {
+          data = REAL(x);
+          if(set.threads > 1 && x_len >= set.thread_min_len)
+            simd_i = VALC_all_bw_real_par(
+              data, x_len, lo_num, hi_num, inc_lo, inc_hi, na_rm_int,
+              set.threads
+            );
+          else
+            simd_i = VALC_all_bw_real_simd(
+              data, 0, x_len, lo_num, hi_num, inc_lo, inc_hi, na_rm_int
+            );
+      } }
+
+      if(simd_i >= 0) {
+        i = simd_i;
+        success = simd_i == x_len;
+      } else if(!lo_unbound && !hi_unbound) {
         if(!inc_lo && !inc_hi) {
           if(na_rm_int) {
             for(i = 0; i < x_len; ++i) {
@@ -357,11 +383,32 @@ SEXP VALC_all_bw(
       // Re: above, looks like we only need to worry about it in the lo_unbound
       // case.
 
-      int * data = INTEGER(x);
+      int * data = NULL;
       int lo_num = lo_int;
       int hi_num = hi_int;
 
-      if(!lo_unbound && !hi_unbound) {
+      R_xlen_t simd_i = -1;
+      if(!(lo_unbound && hi_unbound && na_rm_int)) {
+        simd_i = VALC_all_bw_int_altrep(
+          x, x_len, lo_num, hi_num, inc_lo, inc_hi, na_rm_int
+        );
+        if(simd_i < 0) {
+          data = INTEGER(x);
+          if(set.threads > 1 && x_len >= set.thread_min_len)
+            simd_i = VALC_all_bw_int_par(
+              data, x_len, lo_num, hi_num, inc_lo, inc_hi, na_rm_int,
+              set.threads
+            );
+          else
+            simd_i = VALC_all_bw_int_simd(
+              data, 0, x_len, lo_num, hi_num, inc_lo, inc_hi, na_rm_int
+            );
+      } }
+
+      if(simd_i >= 0) {
+        i = simd_i;
+        success = simd_i == x_len;
+      } else if(!lo_unbound && !hi_unbound) {
         if(!inc_lo && !inc_hi) {
           if(na_rm_int) {
             for(i = 0; i < x_len; ++i) {
@@ -754,11 +801,14 @@ SEXP VALC_all_bw(
       UNPROTECT(4);
       msg_val = CSR_smprintf2(10000, "\"%s\"", msg_val_sub, "");
     } else {
+      // `_ELT` accessors so we don't materialize ALTREP vectors
+      int x_int = x_type == INTSXP ? INTEGER_ELT(x, i) :
+        x_type == LGLSXP ? LOGICAL_ELT(x, i) : 0;
       msg_val = CSR_num_as_chr(
         (double)(x_type == REALSXP ?
-          REAL(x)[i] :
+          REAL_ELT(x, i) :
           // NA_INT doesn't print as NA after coercion to dbl, NA_REAL does
-          (INTEGER(x)[i] == NA_INTEGER ? NA_REAL : INTEGER(x)[i] )
+          (x_int == NA_INTEGER ? NA_REAL : x_int)
         ), 0
       );
     }
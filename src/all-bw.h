@@ -1,8 +1,35 @@
 #include "cstringr.h"
+#include "settings.h"
 
 #ifndef _ALLBW_H
 #define _ALLBW_H
 
-  SEXP VALC_all_bw(SEXP x, SEXP hi, SEXP lo, SEXP na_rm, SEXP include_bounds);
+  SEXP VALC_all_bw(
+    SEXP x, SEXP hi, SEXP lo, SEXP na_rm, SEXP include_bounds, SEXP settings
+  );
+  R_xlen_t VALC_all_bw_real_simd(
+    const double * x, R_xlen_t start, R_xlen_t end, double lo, double hi,
+    int inc_lo, int inc_hi, int na_rm
+  );
+  R_xlen_t VALC_all_bw_int_simd(
+    const int * x, R_xlen_t start, R_xlen_t end, int lo, int hi,
+    int inc_lo, int inc_hi, int na_rm
+  );
+  R_xlen_t VALC_all_bw_real_par(
+    const double * x, R_xlen_t len, double lo, double hi,
+    int inc_lo, int inc_hi, int na_rm, int threads
+  );
+  R_xlen_t VALC_all_bw_int_par(
+    const int * x, R_xlen_t len, int lo, int hi,
+    int inc_lo, int inc_hi, int na_rm, int threads
+  );
+  R_xlen_t VALC_all_bw_real_altrep(
+    SEXP x, R_xlen_t len, double lo, double hi, int inc_lo, int inc_hi,
+    int na_rm
+  );
+  R_xlen_t VALC_all_bw_int_altrep(
+    SEXP x, R_xlen_t len, int lo, int hi, int inc_lo, int inc_hi, int na_rm
+  );
+  int VALC_all_int_like(SEXP x);
 
 #endif
@@ -419,6 +419,30 @@ SEXP ALIKEC_compare_dim_ext(
 /*-----------------------------------------------------------------------------\
 \-----------------------------------------------------------------------------*/
 /*
+Row names in the compact `c(NA_integer_, n)` form R uses for automatic row
+names; these must always be read from ATTRIB directly as `getAttrib` expands
+them into an `n` length integer vector.
+*/
+static int ALIKEC_is_compact_row_names(SEXP x) {
+  return TYPEOF(x) == INTSXP && XLENGTH(x) == 2 &&
+    INTEGER(x)[0] == NA_INTEGER && ATTRIB(x) == R_NilValue;
+}
+/*
+Returns 1 if the raw `row.names` attribute values are known to be alike
+without running the general special char attribute comparison, i.e. if both
+are compact with the same row count, or the template is zero length and the
+current ones are compact.  This is O(1) irrespective of the number of rows.
+*/
+int ALIKEC_row_names_compact_alike(SEXP target, SEXP current) {
+  if(!ALIKEC_is_compact_row_names(current)) return 0;
+  if(
+    TYPEOF(target) == INTSXP && !XLENGTH(target) && ATTRIB(target) == R_NilValue
+  )
+    return 1;
+  return ALIKEC_is_compact_row_names(target) &&
+    INTEGER(target)[1] == INTEGER(current)[1];
+}
+/*
 check that an attribute could be `names`, `rownames` etc base on attributes
 */
 int ALIKEC_are_special_char_attrs_internal(SEXP target, SEXP current) {
@@ -931,6 +955,56 @@ struct ALIKEC_res ALIKEC_compare_attributes_internal_simple(
   UNPROTECT(2);
   return res;
 }
+/*
+Fast path for the common case where both objects have the same attributes in
+the same order (e.g. from the same constructor) and all the attribute values are
+identical, in which case they are necessarily alike.  We just merge walk the two
+pairlists without sorting or allocating anything.
+
+Returns 1 if the attributes are known to be alike, and sets `is_df` as
+`ALIKEC_compare_class` would, or 0 if we need to run the full comparison, which
+could still find the attributes alike (e.g. wildcard names).
+*/
+static int ALIKEC_compare_attributes_fast(
+  SEXP target, SEXP current, SEXP tar_attr, SEXP cur_attr,
+  struct VALC_settings set, int * is_df
+) {
+  *is_df = 0;
+  for(
+    ;
+    tar_attr != R_NilValue && cur_attr != R_NilValue;
+    tar_attr = CDR(tar_attr), cur_attr = CDR(cur_attr)
+  ) {
+    SEXP tag = TAG(tar_attr);
+    SEXP tar_val = CAR(tar_attr), cur_val = CAR(cur_attr);
+
+    if(tag != TAG(cur_attr)) return 0;
+    if(
+      tar_val != cur_val &&
+      (
+        TYPEOF(tar_val) != TYPEOF(cur_val) ||
+        !R_compute_identical(tar_val, cur_val, 16)
+      )
+    )
+      return 0;
+
+    if(!set.attr_mode) {
+      // Identical dims can still be an implicit class mismatch (see
+      // `ALIKEC_compare_dims`)
+
+      if(
+        tag == R_DimSymbol &&
+        isVectorAtomic(target) != isVectorAtomic(current)
+      )
+        return 0;
+
+      if(tag == R_ClassSymbol && TYPEOF(tar_val) == STRSXP) {
+        R_xlen_t class_len = XLENGTH(tar_val);
+        for(R_xlen_t i = 0; i < class_len && !*is_df; ++i)
+          *is_df = !strcmp(CHAR(STRING_ELT(tar_val, i)), "data.frame");
+  } } }
+  return tar_attr == R_NilValue && cur_attr == R_NilValue;
+}
 /* Used by alike to compare attributes;
 
 Code originally inspired by `R_compute_identical` (thanks R CORE)
@@ -951,6 +1025,15 @@ struct ALIKEC_res ALIKEC_compare_attributes_internal(
   cur_attr = ATTRIB(current);
 
   if(tar_attr == R_NilValue && cur_attr == R_NilValue) return res_attr;
+
+  if(
+    ALIKEC_compare_attributes_fast(
+      target, current, tar_attr, cur_attr, set, &is_df
+    )
+  ) {
+    res_attr.dat.df = is_df;
+    return res_attr;
+  }
   /*
   Array to store major errors; to see what each position corresponds to see the
   docs for ALIKEC_res.lvl
@@ -1003,6 +1086,13 @@ struct ALIKEC_res ALIKEC_compare_attributes_internal(
   // what attributes are missing from either list.
 
   while(i < tar_attr_count || j < cur_attr_count) {
+    // With `fast.fail` we don't need the most important failure, any will do
+
+    if(set.fast_fail) {
+      int k = 0;
+      while(k < 8 && errs[k].success) ++k;
+      if(k < 8) break;
+    }
     int i_implicit = 0, j_implicit = 0;
     int i_over = i >= tar_attr_count;
     int j_over = j >= cur_attr_count;
@@ -1152,6 +1242,11 @@ struct ALIKEC_res ALIKEC_compare_attributes_internal(
         (is_names = !strcmp(tar_tag, "names")) || !strcmp(tar_tag, "row.names")
       ) {
         int err_ind = is_names ? 3 : 4;
+        if(
+          !is_names &&
+          ALIKEC_row_names_compact_alike(tar_attr_el_val, cur_attr_el_val)
+        )
+          continue;
         struct ALIKEC_res name_comp =
           ALIKEC_compare_special_char_attrs_internal(
             tar_attr_el_val, cur_attr_el_val, set, 0
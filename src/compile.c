@@ -0,0 +1,234 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "alike.h"
+#include <R_ext/RS.h>
+
+/*
+ * Compiled templates
+ *
+ * `ALIKEC_alike_internal` re-inspects the template on every comparison (type,
+ * S4-ness, attributes, etc.).  For templates that are used over and over we
+ * can walk the template once and record what we need in a flat array of nodes,
+ * with the children of each list node stored contiguously starting at
+ * `child`.
+ *
+ * The compiled plan is only used to establish that an object is alike the
+ * template in the simple (and common) case where the object has the same
+ * structure as the template: same types, same lengths (unless the template
+ * length is zero), and identical attributes.  Anything else, including every
+ * failure, is handed off to `ALIKEC_alike_internal` with the original template
+ * so that the semantics and error messages are exactly those of the
+ * uncompiled template.  Parts of the template we don't handle in the plan
+ * (language, functions, environments, S4 objects, etc.) are marked as opaque
+ * and always cause a hand off.
+ *
+ * The plan is stored in an external pointer with the original template (a
+ * copy of it to guard against modification) as the protected value.  If the
+ * pointer is lost (e.g. after serialization) we just use the template.
+ */
+
+#define ALIKEC_TPL_OPAQUE 0   // not handled by plan, use full comparison
+#define ALIKEC_TPL_WILD 1     // nested NULL, matches anything
+#define ALIKEC_TPL_LEAF 2     // atomic vector
+#define ALIKEC_TPL_LIST 3     // list, children start at `child`
+
+struct ALIKEC_tpl_node {
+  SEXP attr;          // ATTRIB of the template node
+  R_xlen_t len;       // length of template node
+  R_xlen_t child;     // index of first child, for lists
+  SEXPTYPE type;
+  int kind;           // one of the ALIKEC_TPL_* values
+};
+struct ALIKEC_tpl {
+  struct ALIKEC_tpl_node * nodes;
+  R_xlen_t size;
+};
+
+static R_xlen_t ALIKEC_tpl_count(SEXP x) {
+  R_xlen_t count = 1;
+  if(TYPEOF(x) == VECSXP && !IS_S4_OBJECT(x)) {
+    R_xlen_t len = XLENGTH(x);
+    for(R_xlen_t i = 0; i < len; ++i)
+      count += ALIKEC_tpl_count(VECTOR_ELT(x, i));
+  }
+  return count;
+}
+/*
+ * Record node `x` at `nodes[i]`, the children of lists are reserved a block
+ * starting at `*next`.
+ */
+static void ALIKEC_tpl_fill(
+  SEXP x, struct ALIKEC_tpl_node * nodes, R_xlen_t i, R_xlen_t * next
+) {
+  struct ALIKEC_tpl_node * node = nodes + i;
+  SEXPTYPE type = TYPEOF(x);
+
+  node->attr = ATTRIB(x);
+  node->len = xlength(x);
+  node->child = -1;
+  node->type = type;
+  node->kind = ALIKEC_TPL_OPAQUE;
+
+  if(IS_S4_OBJECT(x)) return;
+
+  switch(type) {
+    case NILSXP: node->kind = ALIKEC_TPL_WILD; break;
+    case LGLSXP:
+    case INTSXP:
+    case REALSXP:
+    case CPLXSXP:
+    case STRSXP:
+    case RAWSXP: node->kind = ALIKEC_TPL_LEAF; break;
+    case VECSXP: {
+      node->kind = ALIKEC_TPL_LIST;
+      node->child = *next;
+      *next += node->len;
+      for(R_xlen_t j = 0; j < node->len; ++j)
+        ALIKEC_tpl_fill(VECTOR_ELT(x, j), nodes, node->child + j, next);
+      break;
+    }
+    default: break;
+  }
+}
+/*
+ * Attributes are the same tags in the same order with identical values, see
+ * `ALIKEC_compare_attributes_fast`.
+ */
+static int ALIKEC_tpl_attr(SEXP tar_attr, SEXP cur_attr) {
+  for(
+    ;
+    tar_attr != R_NilValue && cur_attr != R_NilValue;
+    tar_attr = CDR(tar_attr), cur_attr = CDR(cur_attr)
+  ) {
+    SEXP tar_val = CAR(tar_attr), cur_val = CAR(cur_attr);
+    if(TAG(tar_attr) != TAG(cur_attr)) return 0;
+    if(
+      tar_val != cur_val &&
+      (
+        TYPEOF(tar_val) != TYPEOF(cur_val) ||
+        !R_compute_identical(tar_val, cur_val, 16)
+      )
+    )
+      return 0;
+  }
+  return tar_attr == R_NilValue && cur_attr == R_NilValue;
+}
+/*
+ * Run the plan from node `i`
+ *
+ * @return 1 if `current` is known to be alike the template, 0 if we need to
+ *   run the full comparison to find out.
+ */
+static int ALIKEC_tpl_run(
+  struct ALIKEC_tpl_node * nodes, R_xlen_t i, SEXP current,
+  struct VALC_settings set
+) {
+  struct ALIKEC_tpl_node * node = nodes + i;
+  SEXPTYPE cur_type = TYPEOF(current);
+
+  switch(node->kind) {
+    case ALIKEC_TPL_WILD: return 1;
+    case ALIKEC_TPL_LEAF:
+    case ALIKEC_TPL_LIST: break;
+    default: return 0;
+  }
+  // Same checks as `ALIKEC_alike_obj`, but only the success cases; note that
+  // with the types below the dim based implicit class checks cannot fail
+
+  if(
+    cur_type != node->type &&
+    !(node->type == REALSXP && cur_type == INTSXP && set.type_mode < 2)
+  )
+    return 0;
+  if(IS_S4_OBJECT(current)) return 0;
+  if(node->len && node->len != xlength(current)) return 0;
+  if(
+    (node->attr != R_NilValue || ATTRIB(current) != R_NilValue) &&
+    !ALIKEC_tpl_attr(node->attr, ATTRIB(current))
+  )
+    return 0;
+
+  if(node->kind == ALIKEC_TPL_LIST) {
+    for(R_xlen_t j = 0; j < node->len; ++j) {
+      if(!ALIKEC_tpl_run(nodes, node->child + j, VECTOR_ELT(current, j), set))
+        return 0;
+  } }
+  return 1;
+}
+static void ALIKEC_tpl_finalize(SEXP ptr) {
+  struct ALIKEC_tpl * tpl = (struct ALIKEC_tpl *) R_ExternalPtrAddr(ptr);
+  if(tpl) {
+    R_Free(tpl->nodes);
+    R_Free(tpl);
+    R_ClearExternalPtr(ptr);
+  }
+}
+/*
+ * External interface, see R docs for `compile_template`
+ */
+SEXP ALIKEC_compile_template(SEXP target) {
+  if(ALIKEC_is_compiled(target)) return target;
+
+  SEXP tpl_sxp = PROTECT(duplicate(target));
+  R_xlen_t size = ALIKEC_tpl_count(tpl_sxp);
+
+  struct ALIKEC_tpl * tpl = R_Calloc(1, struct ALIKEC_tpl);
+  tpl->nodes = R_Calloc((size_t) size, struct ALIKEC_tpl_node);
+  tpl->size = size;
+
+  SEXP ptr = PROTECT(
+    R_MakeExternalPtr((void *) tpl, ALIKEC_SYM_template, tpl_sxp)
+  );
+  R_RegisterCFinalizerEx(ptr, ALIKEC_tpl_finalize, TRUE);
+
+  R_xlen_t next = 1;
+  ALIKEC_tpl_fill(tpl_sxp, tpl->nodes, 0, &next);
+  if(next != size)
+    error("Internal Error: template node count mismatch; contact maintainer."); // nocov
+
+  UNPROTECT(2);
+  return ptr;
+}
+int ALIKEC_is_compiled(SEXP x) {
+  return TYPEOF(x) == EXTPTRSXP && R_ExternalPtrTag(x) == ALIKEC_SYM_template;
+}
+/*
+ * Like `ALIKEC_alike_internal`, but `target` may also be a compiled template
+ */
+struct ALIKEC_res ALIKEC_alike_tpl(
+  SEXP target, SEXP current, struct VALC_settings set
+) {
+  if(ALIKEC_is_compiled(target)) {
+    struct ALIKEC_tpl * tpl = (struct ALIKEC_tpl *) R_ExternalPtrAddr(target);
+    SEXP tpl_sxp = R_ExternalPtrProtected(target);
+
+    // A top level NULL template is not a wildcard
+
+    if(
+      tpl && (
+        tpl->nodes[0].kind == ALIKEC_TPL_WILD ? current == R_NilValue :
+        ALIKEC_tpl_run(tpl->nodes, 0, current, set)
+      )
+    )
+      return ALIKEC_res_init();
+
+    target = tpl_sxp;
+  }
+  return ALIKEC_alike_internal(target, current, set);
+}
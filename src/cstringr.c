@@ -290,6 +290,93 @@ size_t CSR_add_szt(size_t a, size_t b) {
     );
   return a + b;
 }
+/*
+ * String builder
+ *
+ * Error messages are assembled from many small pieces.  Rather than copying
+ * the pieces and the accumulated string at every step, we append to a buffer
+ * allocated with R_alloc that grows geometrically, so building a string is
+ * linear in its length.  Outgrown buffers are left on the R_alloc stack and are
+ * released with it.
+ *
+ * As with `CSR_strmcpy`, each piece is truncated to `maxlen` with a warning.
+ */
+void CSR_strbuf_init(struct CSR_strbuf * buf, size_t size, size_t maxlen) {
+  if(maxlen == SIZE_MAX)
+    error("Argument `maxlen` must be at least one smaller than SIZE_MAX.");
+  buf->size = CSR_add_szt(size, 1);
+  buf->buf = R_alloc(buf->size, sizeof(char));
+  buf->buf[0] = '\0';
+  buf->len = 0;
+  buf->maxlen = maxlen;
+}
+/*
+ * Length of `str`, truncated to `maxlen`
+ */
+static size_t CSR_strmlen_w(const char * str, size_t maxlen) {
+  if(!maxlen) return 0;
+  size_t len = CSR_strmlen_x(str, maxlen);
+  if(len == maxlen && str[len])
+    warning("CSR_strmcpy: truncated string longer than %d", maxlen);
+  return len;
+}
+/*
+ * Append the first `len` bytes of `str`, which must not contain a NULL
+ */
+void CSR_strbuf_addn(struct CSR_strbuf * buf, const char * str, size_t len) {
+  if(!len) return;
+  size_t need = CSR_add_szt(CSR_add_szt(buf->len, len), 1);
+  if(need > buf->size) {
+    size_t size = buf->size;
+    while(size < need) size = size > SIZE_MAX / 2 ? need : size * 2;
+    char * buf_new = R_alloc(size, sizeof(char));
+    memcpy(buf_new, buf->buf, buf->len);
+    buf->buf = buf_new;
+    buf->size = size;
+  }
+  memcpy(buf->buf + buf->len, str, len);
+  buf->len += len;
+  buf->buf[buf->len] = '\0';
+}
+void CSR_strbuf_add(struct CSR_strbuf * buf, const char * str) {
+  CSR_strbuf_addn(buf, str, CSR_strmlen_w(str, buf->maxlen));
+}
+/*
+ * Substitute `args` into the `%s` tokens of `format` in one pass
+ *
+ * `%%` becomes `%`, and any other `%` is copied as is.  Tokens beyond `narg`
+ * are replaced with the empty string.  `lens` are the lengths of `args`.
+ */
+static void CSR_strbuf_fmt_int(
+  struct CSR_strbuf * buf, const char * format, size_t format_len,
+  const char ** args, const size_t * lens, int narg
+) {
+  const char * fmt_end = format + format_len, * chunk = format;
+  int arg = 0;
+
+  for(const char * fmt = format; fmt < fmt_end; ++fmt) {
+    if(*fmt != '%' || fmt + 1 == fmt_end) continue;
+    if(fmt[1] == 's') {
+      CSR_strbuf_addn(buf, chunk, (size_t) (fmt - chunk));
+      if(arg < narg) CSR_strbuf_addn(buf, args[arg], lens[arg]);
+      ++arg;
+      chunk = ++fmt + 1;
+    } else if(fmt[1] == '%') {
+      CSR_strbuf_addn(buf, chunk, (size_t) (fmt - chunk + 1));
+      chunk = ++fmt + 1;
+    }
+  }
+  CSR_strbuf_addn(buf, chunk, (size_t) (fmt_end - chunk));
+}
+void CSR_strbuf_fmt(
+  struct CSR_strbuf * buf, const char * format, const char ** args, int narg
+) {
+  size_t * lens = (size_t *) R_alloc((size_t) narg, sizeof(size_t));
+  for(int i = 0; i < narg; ++i) lens[i] = CSR_strmlen_w(args[i], buf->maxlen);
+  CSR_strbuf_fmt_int(
+    buf, format, CSR_strmlen_w(format, buf->maxlen), args, lens, narg
+  );
+}
 /*
 Returns a character pointer containing the results of using `a` as the parent
 string and all the others a substrings with `sprintf`
@@ -302,52 +389,30 @@ note:
   reading past buffer size if any of them are smaller than maxlen.  Basically,
   the underlying assumption with all of these is that all inputs are NULL
   terminated
-- If you submit more %s tokens than there are args, bad stuff starts to
-  happen and we don't actually check the formatting tokens
+- only `%s` and `%%` are interpreted, see `CSR_strbuf_fmt_int`; extra `%s`
+  tokens are replaced with the empty string
 */
 
 char * CSR_smprintf6(
   size_t maxlen, const char * format, const char * a, const char * b,
   const char * c, const char * d, const char * e, const char * f
 ) {
-  size_t full_len;
   size_t format_len = CSR_strmlen_x(format, maxlen);
   if(format_len >= maxlen)
     error(
       "Internal Error: formatting string length longer that `nchar.max` %s,",
       "contact maintainer."
     );
-  full_len = CSR_add_szt(format_len, CSR_strmlen_x(a, maxlen));
-  full_len = CSR_add_szt(full_len, CSR_strmlen_x(b, maxlen));
-  full_len = CSR_add_szt(full_len, CSR_strmlen_x(c, maxlen));
-  full_len = CSR_add_szt(full_len, CSR_strmlen_x(d, maxlen));
-  full_len = CSR_add_szt(full_len, CSR_strmlen_x(e, maxlen));
-  full_len = CSR_add_szt(full_len, CSR_strmlen_x(f, maxlen));
-
-  char * res;
-
-  // Limit each string and format to `maxlen`
-
-  char * a_cpy = CSR_strmcpy(a, maxlen);
-  char * b_cpy = CSR_strmcpy(b, maxlen);
-  char * c_cpy = CSR_strmcpy(c, maxlen);
-  char * d_cpy = CSR_strmcpy(d, maxlen);
-  char * e_cpy = CSR_strmcpy(e, maxlen);
-  char * f_cpy = CSR_strmcpy(f, maxlen);
-
-  res = R_alloc(full_len + 1, sizeof(char));
-  int res_len = sprintf(
-    res, CSR_strmcpy(format, maxlen), a_cpy, b_cpy, c_cpy, d_cpy, e_cpy, f_cpy
-  );
-  if(res_len < 0) {
-    // nocov start
-    error("%s%s",
-      "Internal Error (CSR_smprintf): `sprintf` returned -1 when generating ",
-      "new string"
-    );
-    // nocov end
+  const char * args[6] = {a, b, c, d, e, f};
+  size_t lens[6], full_len = format_len;
+  for(int i = 0; i < 6; ++i) {
+    lens[i] = CSR_strmlen_w(args[i], maxlen);
+    full_len = CSR_add_szt(full_len, lens[i]);
   }
-  return res;
+  struct CSR_strbuf res;
+  CSR_strbuf_init(&res, full_len, maxlen);
+  CSR_strbuf_fmt_int(&res, format, format_len, args, lens, 6);
+  return res.buf;
 }
 char * CSR_smprintf5(
   size_t maxlen, const char * format, const char * a, const char * b,
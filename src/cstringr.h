@@ -28,6 +28,15 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 
 #define CSR_MAX_CHAR 50000
 
+  // String builder, see cstringr.c
+
+  struct CSR_strbuf {
+    char * buf;     // always NULL terminated
+    size_t len;     // excluding the NULL terminator
+    size_t size;    // allocated size of `buf`
+    size_t maxlen;  // each appended piece is truncated to this
+  };
+
   // Testing Functions
 
   SEXP CSR_len_chr_len_ext(SEXP a);
@@ -92,6 +101,13 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 
   void CSR_strappend(char * target, const char * str, size_t maxlen);
 
+  void CSR_strbuf_init(struct CSR_strbuf * buf, size_t size, size_t maxlen);
+  void CSR_strbuf_addn(struct CSR_strbuf * buf, const char * str, size_t len);
+  void CSR_strbuf_add(struct CSR_strbuf * buf, const char * str);
+  void CSR_strbuf_fmt(
+    struct CSR_strbuf * buf, const char * format, const char ** args, int narg
+  );
+
   size_t CSR_add_szt(size_t a, size_t b);
 
   // macros, offset is expected to be a pointer to a character
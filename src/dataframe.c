@@ -0,0 +1,173 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "alike.h"
+
+/*
+ * Data frame fast path
+ *
+ * Comparing a data frame with the generic machinery sorts and compares the
+ * attributes, and then recurses into each column with a full object
+ * comparison.  The typical data frame template (e.g. from `abstract`) has zero
+ * rows, plain atomic columns, and only the `names`, `row.names`, and `class`
+ * attributes, so we can establish alikeness by checking the names once and
+ * then scanning the column types and lengths, only looking at column
+ * attributes for the columns that have any.
+ *
+ * As with compiled templates, this only proves success.  Anything unusual,
+ * and every failure, goes through the generic comparison so error messages
+ * are unchanged.
+ */
+
+/*
+ * The `names`, `row.names`, and `class` attribute values of a data frame, or
+ * 0 if it has any other attributes.
+ */
+static int ALIKEC_df_attrs(
+  SEXP x, SEXP * names, SEXP * row_names, SEXP * klass
+) {
+  *names = *row_names = *klass = R_NilValue;
+  for(SEXP attr = ATTRIB(x); attr != R_NilValue; attr = CDR(attr)) {
+    SEXP tag = TAG(attr);
+    if(tag == R_NamesSymbol) *names = CAR(attr);
+    else if(tag == R_RowNamesSymbol) *row_names = CAR(attr);
+    else if(tag == R_ClassSymbol) *klass = CAR(attr);
+    else return 0;
+  }
+  return
+    TYPEOF(*names) == STRSXP && ATTRIB(*names) == R_NilValue &&
+    TYPEOF(*klass) == STRSXP &&
+    (TYPEOF(*row_names) == INTSXP || TYPEOF(*row_names) == STRSXP);
+}
+static int ALIKEC_df_is_df(SEXP klass) {
+  R_xlen_t len = XLENGTH(klass);
+  for(R_xlen_t i = 0; i < len; ++i)
+    if(!strcmp(CHAR(STRING_ELT(klass, i)), "data.frame")) return 1;
+  return 0;
+}
+static int ALIKEC_df_same_chr(SEXP tar, SEXP cur, int blank_ok) {
+  R_xlen_t len = XLENGTH(tar);
+  if(len != XLENGTH(cur)) return 0;
+  for(R_xlen_t i = 0; i < len; ++i) {
+    SEXP tar_chr = STRING_ELT(tar, i);
+    if(
+      tar_chr != STRING_ELT(cur, i) && !(blank_ok && tar_chr == R_BlankString)
+    )
+      return 0;
+  }
+  return 1;
+}
+/*
+ * Column attributes, same tags in same order with identical values
+ */
+static int ALIKEC_df_col_attr(SEXP tar_attr, SEXP cur_attr) {
+  for(
+    ;
+    tar_attr != R_NilValue && cur_attr != R_NilValue;
+    tar_attr = CDR(tar_attr), cur_attr = CDR(cur_attr)
+  ) {
+    SEXP tar_val = CAR(tar_attr), cur_val = CAR(cur_attr);
+    if(TAG(tar_attr) != TAG(cur_attr)) return 0;
+    if(
+      tar_val != cur_val &&
+      (
+        TYPEOF(tar_val) != TYPEOF(cur_val) ||
+        !R_compute_identical(tar_val, cur_val, 16)
+      )
+    )
+      return 0;
+  }
+  return tar_attr == R_NilValue && cur_attr == R_NilValue;
+}
+/*
+ * @return 1 if `current` is known to be alike data frame `target`, 0 if we
+ *   need to run the full comparison to find out.
+ */
+int ALIKEC_alike_df_fast(SEXP target, SEXP current, struct VALC_settings set) {
+  if(
+    set.attr_mode || TYPEOF(target) != VECSXP || TYPEOF(current) != VECSXP ||
+    IS_S4_OBJECT(target) || IS_S4_OBJECT(current)
+  )
+    return 0;
+
+  SEXP tar_names, tar_rn, tar_class, cur_names, cur_rn, cur_class;
+  if(
+    !ALIKEC_df_attrs(target, &tar_names, &tar_rn, &tar_class) ||
+    !ALIKEC_df_attrs(current, &cur_names, &cur_rn, &cur_class) ||
+    !ALIKEC_df_is_df(tar_class)
+  )
+    return 0;
+
+  // Same class, same column count, names with `""` as wildcards, and row
+  // names that are either the same or zero length in the template
+
+  R_xlen_t col_num = XLENGTH(target);
+  if(
+    !col_num || col_num != XLENGTH(current) ||
+    XLENGTH(tar_names) != col_num ||
+    (tar_class != cur_class && !ALIKEC_df_same_chr(tar_class, cur_class, 0)) ||
+    (tar_names != cur_names && !ALIKEC_df_same_chr(tar_names, cur_names, 1))
+  )
+    return 0;
+
+  if(
+    tar_rn != cur_rn && !ALIKEC_row_names_compact_alike(tar_rn, cur_rn) &&
+    !(
+      TYPEOF(tar_rn) == TYPEOF(cur_rn) &&
+      ATTRIB(tar_rn) == R_NilValue && ATTRIB(cur_rn) == R_NilValue &&
+      (!XLENGTH(tar_rn) || R_compute_identical(tar_rn, cur_rn, 16))
+  ) )
+    return 0;
+
+  // Columns
+
+  for(R_xlen_t i = 0; i < col_num; ++i) {
+    SEXP tar_col = VECTOR_ELT(target, i);
+    SEXP cur_col = VECTOR_ELT(current, i);
+    if(tar_col == R_NilValue) continue;  // nested NULL is a wildcard
+
+    SEXPTYPE tar_type = TYPEOF(tar_col), cur_type = TYPEOF(cur_col);
+    switch(tar_type) {
+      case LGLSXP:
+      case INTSXP:
+      case REALSXP:
+      case CPLXSXP:
+      case STRSXP:
+      case RAWSXP: break;
+      default: return 0;
+    }
+    if(
+      cur_type != tar_type &&
+      !(tar_type == REALSXP && cur_type == INTSXP && set.type_mode < 2)
+    )
+      return 0;
+
+    R_xlen_t tar_len = XLENGTH(tar_col);
+    if(tar_len && tar_len != XLENGTH(cur_col)) return 0;
+
+    SEXP tar_attr = ATTRIB(tar_col), cur_attr = ATTRIB(cur_col);
+    if(
+      (tar_attr != R_NilValue || cur_attr != R_NilValue) &&
+      (
+        IS_S4_OBJECT(tar_col) || IS_S4_OBJECT(cur_col) ||
+        !ALIKEC_df_col_attr(tar_attr, cur_attr)
+    ) )
+      return 0;
+  }
+  return 1;
+}
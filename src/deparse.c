@@ -0,0 +1,163 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "alike.h"
+
+/*
+ * Native deparse for simple language objects
+ *
+ * Error messages deparse the object being checked, e.g. `x[[1]]$a` in
+ * "`x[[1]]$a` should be ...", and the function being called in language
+ * comparisons.  Going through the R level `deparse` for these requires an R
+ * call and deparses the whole object even if we only end up using the first
+ * line.
+ *
+ * Here we handle the common shapes directly: symbols, `$` with symbol names,
+ * `[[` and `[` subsetting with simple scalar indices, and plain function
+ * calls, all made of syntactic ASCII names.  We stop as soon as the output is
+ * wider than the width cutoff, since that is the point where `deparse` could
+ * start breaking lines.  Anything else, including objects with attributes, is
+ * left to `deparse`.
+ */
+
+#define ALIKEC_DEP_MAX_DEPTH 64
+
+/*
+ * Syntactic ASCII name that `deparse` will output as is
+ */
+static int ALIKEC_dep_plain_name(const char * name) {
+  const char * p = name;
+  if(!isalpha((unsigned char) *p) && *p != '.') return 0;
+  if(p[0] == '.' && (isdigit((unsigned char) p[1]) || p[1] == '.')) return 0;
+  for(++p; *p; ++p)
+    if(!isalnum((unsigned char) *p) && *p != '.' && *p != '_') return 0;
+  return !ALIKEC_is_keyword(name);
+}
+/*
+ * Scalar index values, only the ones where we are certain of what `deparse`
+ * produces
+ */
+static int ALIKEC_dep_const(SEXP x, struct CSR_strbuf * buf) {
+  SEXPTYPE type = TYPEOF(x);
+  if(
+    (type != INTSXP && type != REALSXP && type != STRSXP) ||
+    ATTRIB(x) != R_NilValue || XLENGTH(x) != 1
+  )
+    return 0;
+
+  char num[16];
+  switch(type) {
+    case INTSXP: {
+      int val = INTEGER(x)[0];
+      if(val < 0) return 0;   // also NA
+      snprintf(num, sizeof(num), "%dL", val);
+      CSR_strbuf_add(buf, num);
+      break;
+    }
+    case REALSXP: {
+      // larger values may be shown in scientific notation
+      double val = REAL(x)[0];
+      if(!(val >= 0 && val < 1e5) || val != (double) (int) val) return 0;
+      snprintf(num, sizeof(num), "%d", (int) val);
+      CSR_strbuf_add(buf, num);
+      break;
+    }
+    case STRSXP: {
+      SEXP chr = STRING_ELT(x, 0);
+      if(chr == NA_STRING || (size_t) LENGTH(chr) > CSR_MAX_CHAR) return 0;
+      for(const char * p = CHAR(chr); *p; ++p)
+        if(*p < ' ' || *p > '~' || *p == '"' || *p == '\\') return 0;
+      CSR_strbuf_add(buf, "\"");
+      CSR_strbuf_add(buf, CHAR(chr));
+      CSR_strbuf_add(buf, "\"");
+      break;
+    }
+    default: return 0;
+  }
+  return 1;
+}
+static int ALIKEC_dep_rec(
+  SEXP x, struct CSR_strbuf * buf, size_t limit, int depth
+) {
+  if(depth > ALIKEC_DEP_MAX_DEPTH || buf->len > limit) return 0;
+
+  switch(TYPEOF(x)) {
+    case SYMSXP: {
+      const char * name = CHAR(PRINTNAME(x));
+      if(!ALIKEC_dep_plain_name(name)) return 0;
+      CSR_strbuf_add(buf, name);
+      return buf->len <= limit;
+    }
+    case LANGSXP: break;
+    default: return ALIKEC_dep_const(x, buf) && buf->len <= limit;
+  }
+  SEXP fun = CAR(x), args = CDR(x);
+  if(ATTRIB(x) != R_NilValue || TYPEOF(fun) != SYMSXP) return 0;
+
+  if(fun == R_DollarSymbol) {
+    if(
+      CDR(args) == R_NilValue || CDDR(args) != R_NilValue ||
+      TAG(args) != R_NilValue || TAG(CDR(args)) != R_NilValue ||
+      TYPEOF(CADR(args)) != SYMSXP
+    )
+      return 0;
+    if(!ALIKEC_dep_rec(CAR(args), buf, limit, depth + 1)) return 0;
+    CSR_strbuf_add(buf, "$");
+    return ALIKEC_dep_rec(CADR(args), buf, limit, depth + 1);
+  }
+  const char * open = "(", * close = ")";
+  if(fun == R_Bracket2Symbol || fun == R_BracketSymbol) {
+    // subsetting: object, then the indices in brackets
+    if(args == R_NilValue || TAG(args) != R_NilValue) return 0;
+    if(!ALIKEC_dep_rec(CAR(args), buf, limit, depth + 1)) return 0;
+    args = CDR(args);
+    if(fun == R_Bracket2Symbol) {open = "[["; close = "]]";}
+    else {open = "["; close = "]";}
+  } else {
+    if(!ALIKEC_dep_rec(fun, buf, limit, depth + 1)) return 0;
+  }
+  CSR_strbuf_add(buf, open);
+  for(SEXP arg = args; arg != R_NilValue; arg = CDR(arg)) {
+    if(arg != args) CSR_strbuf_add(buf, ", ");
+    SEXP tag = TAG(arg);
+    if(tag != R_NilValue) {
+      if(!ALIKEC_dep_rec(tag, buf, limit, depth + 1)) return 0;
+      CSR_strbuf_add(buf, " = ");
+    }
+    if(!ALIKEC_dep_rec(CAR(arg), buf, limit, depth + 1)) return 0;
+  }
+  CSR_strbuf_add(buf, close);
+  return buf->len <= limit;
+}
+/*
+ * @param width_cutoff as for `deparse`, negative for the default
+ * @return a character(1L) with the deparsed object, or NULL if we need to use
+ *   `deparse` instead
+ */
+SEXP ALIKEC_deparse_fast(SEXP obj, int width_cutoff) {
+  if(TYPEOF(obj) != SYMSXP && TYPEOF(obj) != LANGSXP) return R_NilValue;
+  size_t limit = width_cutoff < 0 ? 60 : (size_t) width_cutoff;
+
+  const void * vmax = vmaxget();
+  struct CSR_strbuf buf;
+  CSR_strbuf_init(&buf, limit, CSR_MAX_CHAR);
+  SEXP res = R_NilValue;
+  if(ALIKEC_dep_rec(obj, &buf, limit, 0)) res = mkString(buf.buf);
+  vmaxset(vmax);
+  return res;
+}
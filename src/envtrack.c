@@ -23,7 +23,13 @@ We need environment stack tracking that will not persist across .Call calls
 */
 
 /*
-Allocated and re-allocate our env stack tracking object
+Allocated and re-allocate our env tracking object
+
+The environments are stored in a tracking hash (see trackinghash.c) so that
+checking whether we've seen one is O(1), and so that we can forget the ones
+added after a given point.  We still grow the capacity in
+doublings from `stack_size_init` so that the `env.depth.max` limit applies
+exactly as it did when this was a linear stack.
 
 Return 0 for failure, 1 for normal success, 2 for success requiring
 re-allocation, 3 for success requiring re-allocation and copying
@@ -61,18 +67,14 @@ int ALIKEC_env_stack_alloc(
     }
     if(stack_size > env_limit) return 0;
 
-    SEXP * env_stack_tmp = (SEXP *) R_alloc(stack_size, sizeof(SEXP));
     envs->stack_size = stack_size;
 
     success = 2;
-    if(envs->env_stack == 0) {
-      envs->env_stack = env_stack_tmp;
+    if(envs->env_hash == 0) {
+      envs->env_hash = VALC_create_track_hash((size_t) stack_size);
     } else if(envs->stack_size > stack_size_old) {
-      // Prev allocation happened, need to copy pointers
-      for(int i = 0; i < stack_size_old; i++)
-        env_stack_tmp[i] = envs->env_stack[i];
-      // ideally would free env_stack before repointing...
-      envs->env_stack = env_stack_tmp;
+      // Prev allocation happened, hash re-inserts existing entries
+      VALC_ptr_hash_reserve(envs->env_hash->hash, (size_t) stack_size);
       success = 3;
     }
   }
@@ -94,7 +96,7 @@ struct ALIKEC_env_track * ALIKEC_env_set_create(
   struct ALIKEC_env_track * envs =
     (struct ALIKEC_env_track *) R_alloc(1, sizeof(struct ALIKEC_env_track));
   envs->stack_size = envs->stack_ind = 0;
-  envs->env_stack = 0;
+  envs->env_hash = 0;
   envs->no_rec = 0;
   envs->stack_size_init = stack_size_init;
   int res = ALIKEC_env_stack_alloc(envs, env_limit);
@@ -105,15 +107,6 @@ struct ALIKEC_env_track * ALIKEC_env_set_create(
 /*
 Track what environments we've checked already
 
-Not super efficient allocation here; we should really free previous allocation
-instead of just leaving it hanging until .Call ends.
-
-Also, this should really be a linked list so we don't have to re-copy all the
-pointers every time we expand the list.
-
-Really taking solace in the point that this part of the code should be rarely
-activated.
-
 Returns
   * > 1 if the environment has not been seen before (and adds it to stack),
     really it is the result of the allocation attempt
@@ -126,19 +119,18 @@ int ALIKEC_env_track(
 ) {
   int alloc_res;
   if(!(alloc_res = ALIKEC_env_stack_alloc(envs, env_limit))) return -1;
-  int env_found = 0;
-  for(int i = 0; i < envs->stack_ind; i++) {
-    if(env == envs->env_stack[i]) {
-      env_found = 1;
-      break;
-    }
-  }
-  if(env_found) return 0;
-  envs->env_stack[envs->stack_ind] = env;
+  if(!VALC_add_to_track_hash(envs->env_hash, env)) return 0;
   envs->stack_ind++;
   return alloc_res;
 }
 /*
+Forget all but the first `idx` environments tracked
+*/
+void ALIKEC_env_track_reset(struct ALIKEC_env_track * envs, int idx) {
+  VALC_reset_track_hash(envs->env_hash, (size_t) idx);
+  envs->stack_ind = idx;
+}
+/*
 External interface purely for testing whether our environment hashing
 is working
 */
@@ -17,7 +17,302 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 */
 
 #include "validate.h"
+#include <string.h>
 
+/* -------------------------------------------------------------------------- *\
+\* -------------------------------------------------------------------------- */
+/*
+ * Dispatch for `||` chains of templates
+ *
+ * Long chains of alternative templates are normally tried in order, with a full
+ * template evaluation and `alike` comparison for each alternative until one
+ * matches.  For chains the parser marked (see `VALC_or_tpl_index`) we first
+ * try only the templates whose last known type and first class could match the
+ * object being validated.  If one of those matches we are done since only one
+ * alternative needs to succeed.
+ *
+ * Otherwise we go through the chain in order, so failures, including template
+ * evaluation errors, are reported exactly as they would be without the
+ * dispatch.  Templates the dispatch already tried are not evaluated again;
+ * instead we use the values, comparison results, or errors it recorded, so
+ * only the alternatives it skipped are evaluated in this second pass.  The
+ * type and class hints are only hints: if one of the skipped alternatives
+ * matches, a template must have changed since we last saw it, so we reset the
+ * hints.
+ */
+/*
+ * What the dispatch found out about the templates it tried, indexed as the
+ * dispatch table.  `tpl` and `wrap` are lists that hold and protect the
+ * template values and the `alike` result wraps.
+ */
+#define VALC_OR_UNTRIED 0
+#define VALC_OR_EVALED 1  // evaluated, but not compared
+#define VALC_OR_FAILED 2  // evaluated and compared, but not alike
+#define VALC_OR_ERROR 3   // evaluation failed
+
+struct VALC_or_tried {
+  char * status;
+  struct VALC_res * res;
+  SEXP tpl;
+  SEXP wrap;
+  const char * err_msg;
+};
+/*
+ * Whether a template with SEXPTYPE `tar_type` and first class `tar_class`
+ * (NA_STRING if none) could be alike `current`; this must return 1 if there is
+ * any chance the comparison succeeds, but may do so in other cases too.
+ */
+static int VALC_or_key_match(int tar_type, SEXP tar_class, SEXP current) {
+  if(tar_type == VALC_OR_KEY_UNKNOWN || tar_type == VALC_OR_KEY_ANY)
+    return 1;
+  if(IS_S4_OBJECT(current)) return 1;
+
+  int cur_type = TYPEOF(current);
+  if(tar_type != cur_type) {
+    int tar_num = tar_type == INTSXP || tar_type == REALSXP;
+    int cur_num = cur_type == INTSXP || cur_type == REALSXP;
+    int tar_fun =
+      tar_type == CLOSXP || tar_type == BUILTINSXP || tar_type == SPECIALSXP;
+    int cur_fun =
+      cur_type == CLOSXP || cur_type == BUILTINSXP || cur_type == SPECIALSXP;
+    int tar_lang = tar_type == LANGSXP || tar_type == SYMSXP;
+    int cur_lang = cur_type == LANGSXP || cur_type == SYMSXP;
+    if(
+      !((tar_num && cur_num) || (tar_fun && cur_fun) || (tar_lang && cur_lang))
+    )
+      return 0;
+  }
+  if(tar_class != NA_STRING) {
+    // `current` must have the template classes at the end of its own
+    for(SEXP attr = ATTRIB(current); attr != R_NilValue; attr = CDR(attr)) {
+      if(TAG(attr) != R_ClassSymbol) continue;
+      SEXP klass = CAR(attr);
+      if(TYPEOF(klass) != STRSXP) return 0;
+      for(R_xlen_t i = 0; i < XLENGTH(klass); ++i)
+        if(STRING_ELT(klass, i) == tar_class) return 1;
+      return 0;
+    }
+    return 0;
+  }
+  return 1;
+}
+/*
+ * Record the type and first class of the value template `i` produced.
+ *
+ * Templates that can match objects of other types, i.e. NULL, which is a
+ * wildcard when nested, and S4 objects, are recorded as matching anything.
+ */
+static void VALC_or_key_set(SEXP tbl, R_xlen_t i, SEXP tpl) {
+  if(ALIKEC_is_compiled(tpl)) tpl = R_ExternalPtrProtected(tpl);
+  SEXP klass = NA_STRING;
+  int type = TYPEOF(tpl);
+
+  if(type == NILSXP || IS_S4_OBJECT(tpl)) type = VALC_OR_KEY_ANY;
+  else {
+    SEXP klass_attr = getAttrib(tpl, R_ClassSymbol);
+    if(TYPEOF(klass_attr) == STRSXP && XLENGTH(klass_attr))
+      klass = STRING_ELT(klass_attr, 0);
+  }
+  INTEGER(VECTOR_ELT(tbl, 0))[i] = type;
+  SET_STRING_ELT(VECTOR_ELT(tbl, 1), i, klass);
+}
+static void VALC_or_key_reset(SEXP tbl) {
+  SEXP types = VECTOR_ELT(tbl, 0);
+  for(R_xlen_t i = 0; i < XLENGTH(types); ++i)
+    INTEGER(types)[i] = VALC_OR_KEY_UNKNOWN;
+}
+/*
+ * Try the templates in the `||` chain `lang` that could match `arg_value`.
+ *
+ * @param alt index of the next template in the chain
+ * @param tried where we record what we learn about each template we try
+ * @return 1 if one matched, in which case that success is added to
+ *   `res_list`, 0 if none did, or -1 if a template failed to evaluate, in
+ *   which case we stop trying templates so that the in order evaluation
+ *   reports the error.  `res_list` is unchanged unless we return 1.
+ */
+static int VALC_or_dispatch(
+  SEXP lang, SEXP act_codes, SEXP tbl, R_xlen_t * alt, SEXP arg_value,
+  struct VALC_settings set, struct VALC_res_list * res_list,
+  struct VALC_or_tried * tried
+) {
+  if(TYPEOF(act_codes) == LISTSXP && asInteger(CAR(act_codes)) == 2) {
+    for(
+      lang = CDR(lang), act_codes = CDR(act_codes); lang != R_NilValue;
+      lang = CDR(lang), act_codes = CDR(act_codes)
+    ) {
+      int res = VALC_or_dispatch(
+        CAR(lang), CAR(act_codes), tbl, alt, arg_value, set, res_list, tried
+      );
+      if(res) return res;
+    }
+    return 0;
+  }
+  R_xlen_t i = (*alt)++;
+  if(i >= XLENGTH(VECTOR_ELT(tbl, 0))) {
+    // nocov start
+    error("Internal Error: `||` dispatch table too short; contact maintainer.");
+    // nocov end
+  }
+  if(
+    !VALC_or_key_match(
+      INTEGER(VECTOR_ELT(tbl, 0))[i], STRING_ELT(VECTOR_ELT(tbl, 1), i),
+      arg_value
+  ) )
+    return 0;
+
+  // Evaluation errors are left for the in order evaluation to report; we
+  // must not go on to later templates as one of those matching would hide the
+  // error.  The message is not shown until then, so we keep a copy.
+
+  int err_val = 0;
+  SEXP tpl = PROTECT(R_tryEvalSilent(lang, set.env, &err_val));
+  if(err_val) {
+    const char * err_buf = R_curErrorBuf();
+    char * err_msg = R_alloc(strlen(err_buf) + 1, sizeof(char));
+    strcpy(err_msg, err_buf);
+    tried->err_msg = err_msg;
+    tried->status[i] = VALC_OR_ERROR;
+    UNPROTECT(1);
+    return -1;
+  }
+  SET_VECTOR_ELT(tried->tpl, i, tpl);
+  tried->status[i] = VALC_OR_EVALED;
+  VALC_or_key_set(tbl, i, tpl);
+  int success = 0;
+  if(
+    VALC_or_key_match(
+      INTEGER(VECTOR_ELT(tbl, 0))[i], STRING_ELT(VECTOR_ELT(tbl, 1), i),
+      arg_value
+  ) ) {
+    struct ALIKEC_res res_alike = ALIKEC_alike_tpl(tpl, arg_value, set);
+    PROTECT(res_alike.wrap);
+    struct VALC_res eval_res;
+    eval_res.tpl = 1;
+    eval_res.success = success = res_alike.success;
+    eval_res.dat.tpl_dat = res_alike.dat;
+    eval_res.dat.sxp_dat = res_alike.wrap;
+    if(success) {
+      *res_list = VALC_res_add(*res_list, eval_res);
+    } else {
+      SET_VECTOR_ELT(tried->wrap, i, res_alike.wrap);
+      tried->res[i] = eval_res;
+      tried->status[i] = VALC_OR_FAILED;
+    }
+    UNPROTECT(1);
+  }
+  UNPROTECT(1);
+  return success;
+}
+struct VALC_res_list VALC_evaluate_recurse(
+  SEXP lang, SEXP act_codes, SEXP lang2, SEXP arg_value, SEXP arg_lang,
+  SEXP arg_tag, SEXP lang_full, struct VALC_settings set,
+  struct VALC_res_list res_list
+);
+/*
+ * Evaluate the `||` chain `lang` in order after the dispatch failed, reusing
+ * what it learned about the templates it tried.
+ *
+ * @param alt index of the next template in the chain
+ * @return 1 if an alternative matched, 0 otherwise; results are added to
+ *   `res_list` as `VALC_evaluate_recurse` would.
+ */
+static int VALC_or_evaluate_rec(
+  SEXP lang, SEXP act_codes, SEXP lang2, R_xlen_t * alt,
+  struct VALC_or_tried * tried, SEXP arg_value, SEXP arg_lang, SEXP arg_tag,
+  SEXP lang_full, struct VALC_settings set, struct VALC_res_list * res_list
+) {
+  if(TYPEOF(act_codes) == LISTSXP && asInteger(CAR(act_codes)) == 2) {
+    for(
+      lang = CDR(lang), lang2 = CDR(lang2), act_codes = CDR(act_codes);
+      lang != R_NilValue;
+      lang = CDR(lang), lang2 = CDR(lang2), act_codes = CDR(act_codes)
+    ) {
+      if(
+        VALC_or_evaluate_rec(
+          CAR(lang), CAR(act_codes), CAR(lang2), alt, tried, arg_value,
+          arg_lang, arg_tag, lang_full, set, res_list
+      ) )
+        return 1;
+    }
+    return 0;
+  }
+  R_xlen_t i = (*alt)++;
+  struct VALC_res eval_res;
+
+  switch(tried->status[i]) {
+    case VALC_OR_UNTRIED:
+      *res_list = VALC_evaluate_recurse(
+        lang, act_codes, lang2, arg_value, arg_lang, arg_tag, lang_full, set,
+        *res_list
+      );
+      return res_list->list_tpl[res_list->idx - 1].success;
+    case VALC_OR_EVALED: {
+      struct ALIKEC_res res_alike =
+        ALIKEC_alike_tpl(VECTOR_ELT(tried->tpl, i), arg_value, set);
+      PROTECT(res_alike.wrap);
+      eval_res.tpl = 1;
+      eval_res.success = res_alike.success;
+      eval_res.dat.tpl_dat = res_alike.dat;
+      eval_res.dat.sxp_dat = res_alike.wrap;
+      *res_list = VALC_res_add(*res_list, eval_res);
+      UNPROTECT(1);
+      return eval_res.success;
+    }
+    case VALC_OR_FAILED:
+      *res_list = VALC_res_add(*res_list, tried->res[i]);
+      return 0;
+    case VALC_OR_ERROR:
+      // Show the error as `R_tryEval` would have
+      REprintf("%s", tried->err_msg);
+      VALC_arg_error(
+        arg_tag, lang_full,
+        "Validation expression for argument `%s` produced an error (see previous error)."
+      );
+  }
+  error("Internal Error: bad `||` dispatch status; contact maintainer."); // nocov
+  return 0; // nocov
+}
+/*
+ * Evaluate the `||` chain `lang` that has dispatch table `tbl`, see
+ * `VALC_evaluate_recurse` for params.
+ */
+static struct VALC_res_list VALC_or_evaluate(
+  SEXP lang, SEXP act_codes, SEXP lang2, SEXP tbl, SEXP arg_value,
+  SEXP arg_lang, SEXP arg_tag, SEXP lang_full, struct VALC_settings set,
+  struct VALC_res_list res_list
+) {
+  R_xlen_t tpl_num = XLENGTH(VECTOR_ELT(tbl, 0));
+  struct VALC_or_tried tried = {
+    .status = R_alloc((size_t) tpl_num, sizeof(char)),
+    .res = (struct VALC_res *) R_alloc(
+      (size_t) tpl_num, sizeof(struct VALC_res)
+    ),
+    .tpl = PROTECT(allocVector(VECSXP, tpl_num)),
+    .wrap = PROTECT(allocVector(VECSXP, tpl_num)),
+    .err_msg = ""
+  };
+  memset(tried.status, VALC_OR_UNTRIED, (size_t) tpl_num);
+
+  R_xlen_t alt = 0;
+  if(
+    VALC_or_dispatch(
+      lang, act_codes, tbl, &alt, arg_value, set, &res_list, &tried
+    ) <= 0
+  ) {
+    // A match here means the dispatch missed it, so the hints are stale
+
+    alt = 0;
+    if(
+      VALC_or_evaluate_rec(
+        lang, act_codes, lang2, &alt, &tried, arg_value, arg_lang, arg_tag,
+        lang_full, set, &res_list
+    ) )
+      VALC_or_key_reset(tbl);
+  }
+  UNPROTECT(2);
+  return res_list;
+}
 /* -------------------------------------------------------------------------- *\
 \* -------------------------------------------------------------------------- */
 /*
@@ -58,6 +353,8 @@ struct VALC_res_list VALC_evaluate_recurse(
       if returns character then return character
       if returns FALSE deparse into something like (`x` does not eval to TRUE`)
     if 999, eval as alike
+    if VALC_TOK_NATIVE_MIN to VALC_TOK_NATIVE_MAX, check natively (see
+      tokens.c), or fall back to 10 if we can't
   */
   int mode;
 
@@ -84,7 +381,11 @@ struct VALC_res_list VALC_evaluate_recurse(
       mode=asInteger(CAR(act_codes));
     }
   } else {
-    if(TYPEOF(lang) == LANGSXP || TYPEOF(lang2) == LISTSXP) {
+    mode = asInteger(act_codes);
+    if(
+      (mode < VALC_TOK_NATIVE_MIN || mode > VALC_TOK_NATIVE_MAX) &&
+      (TYPEOF(lang) == LANGSXP || TYPEOF(lang2) == LISTSXP)
+    ) {
       // nocov start
       error("%s%s",
         "Internal Error: mismatched language and eval type tracking 2; contact ",
@@ -92,13 +393,44 @@ struct VALC_res_list VALC_evaluate_recurse(
       );
       // nocov end
     }
-    mode = asInteger(act_codes);
+  }
+  if(mode >= VALC_TOK_NATIVE_MIN && mode <= VALC_TOK_NATIVE_MAX) {
+    // Predefined token with a native implementation; `lang2` still carries
+    // the "err.msg" attribute used for error messages.  If the object isn't one
+    // we can handle natively, evaluate the token in R as a standard token.
+
+    int native_res = VALC_native_token_eval(mode, arg_value);
+    if(native_res >= 0) {
+      struct VALC_res eval_res;
+      SEXP eval_dat = R_NilValue;
+      if(!set.fast_fail) {  // only needed for the error message
+        eval_dat = allocVector(VECSXP, 2);
+        SET_VECTOR_ELT(eval_dat, 0, lang2);
+        SET_VECTOR_ELT(eval_dat, 1, ScalarLogical(native_res));
+      }
+      PROTECT(eval_dat);
+      eval_res.tpl = 0;
+      eval_res.success = native_res;
+      eval_res.dat.sxp_dat = eval_dat;
+      res_list = VALC_res_add(res_list, eval_res);
+      UNPROTECT(1);
+      return(res_list);
+    }
+    mode = 10;
   }
   if(mode == 1 || mode == 2) {
     // Dealing with && or ||, so recurse on each element
 
     if(TYPEOF(lang) == LANGSXP) {
       int parse_count = 0;
+      if(mode == 2 && TYPEOF(act_codes) == LISTSXP) {
+        SEXP or_tbl = getAttrib(CAR(act_codes), VALC_SYM_or_tpl);
+        if(or_tbl != R_NilValue)
+          return VALC_or_evaluate(
+            lang, act_codes, lang2, or_tbl, arg_value, arg_lang, arg_tag,
+            lang_full, set, res_list
+          );
+      }
       lang = CDR(lang);
       lang2 = CDR(lang2);
       act_codes = CDR(act_codes);
@@ -179,7 +511,7 @@ struct VALC_res_list VALC_evaluate_recurse(
       // the protection stack when we're done, but we want the wrap in it, so we
       // use REPROTECT to take over its spot in the stack
 
-      struct ALIKEC_res res_alike = ALIKEC_alike_internal(
+      struct ALIKEC_res res_alike = ALIKEC_alike_tpl(
         VECTOR_ELT(eval_dat, 1), arg_value, set
       );
       REPROTECT(res_alike.wrap, ipx);
@@ -393,7 +725,7 @@ SEXP VALC_evaluate(
   if(!IS_LANG(arg_lang))
     error("Internal Error: argument `arg_lang` must be language.");  // nocov
 
-  SEXP lang_parsed = PROTECT(VALC_parse(lang, arg_lang, set, arg_tag));
+  SEXP lang_parsed = PROTECT(VALC_parse_cached(lang, arg_lang, set, arg_tag));
   struct VALC_res_list res_list, res_init = VALC_res_list_init(set);
   PROTECT(res_init.list_sxp);
 
@@ -423,6 +755,9 @@ SEXP VALC_evaluate(
 
   if(!res_list.idx || res_list.list_tpl[res_list.idx - 1].success) {
     res_as_str = PROTECT(allocVector(VECSXP, 0));
+  } else if(set.fast_fail) {
+    // Caller only needs to know we failed
+    res_as_str = PROTECT(allocVector(VECSXP, 1));
   } else {
     // compute how many failures
 
@@ -40,34 +40,65 @@ fun(a, b, e, f, ..., g, c, e)
 
 */
 
+/*
+Formals of primitive `fun` as reported by `args`.
+
+These can't change during a session, so we look them up once and keep them in
+a table indexed by primitive offset.  Slots we have not looked up yet hold
+R_UnboundValue since R_NilValue is a legitimate result (e.g. for `if`).
+*/
+static SEXP ALIKEC_prim_form_tbl = NULL;
+
+static SEXP ALIKEC_prim_formals(SEXP fun) {
+  int offset = PRIMOFFSET(fun);
+  R_xlen_t size = ALIKEC_prim_form_tbl ? XLENGTH(ALIKEC_prim_form_tbl) : 0;
+
+  if(offset >= size) {
+    R_xlen_t size_new = size ? size : 256;
+    while(size_new <= offset) size_new *= 2;
+    SEXP tbl_new = PROTECT(allocVector(VECSXP, size_new));
+    for(R_xlen_t i = 0; i < size_new; ++i)
+      SET_VECTOR_ELT(
+        tbl_new, i,
+        i < size ? VECTOR_ELT(ALIKEC_prim_form_tbl, i) : R_UnboundValue
+      );
+    R_PreserveObject(tbl_new);
+    if(ALIKEC_prim_form_tbl) R_ReleaseObject(ALIKEC_prim_form_tbl);
+    ALIKEC_prim_form_tbl = tbl_new;
+    UNPROTECT(1);
+  }
+  SEXP formals = VECTOR_ELT(ALIKEC_prim_form_tbl, offset);
+  if(formals == R_UnboundValue) {
+    SEXP args = PROTECT(lang2(ALIKEC_SYM_args, fun));
+    SEXP fun_args = PROTECT(eval(args, R_BaseEnv));
+    formals = TYPEOF(fun_args) == CLOSXP ? FORMALS(fun_args) : R_NilValue;
+    SET_VECTOR_ELT(ALIKEC_prim_form_tbl, offset, formals);
+    UNPROTECT(2);
+  }
+  return formals;
+}
+
 struct ALIKEC_res ALIKEC_fun_alike_internal(
   SEXP target, SEXP current, struct VALC_settings set
 ) {
   if(!isFunction(target) || !isFunction(current))
     error("Arguments must be functions.");
 
-  SEXP tar_form, cur_form, args;
+  SEXP tar_form, cur_form;
   SEXPTYPE tar_type = TYPEOF(target), cur_type = TYPEOF(current);
   struct ALIKEC_res res = ALIKEC_res_init();
 
-  // Translate specials and builtins to formals, if possible
+  // Translate specials and builtins to formals, if possible; the formals are
+  // protected by the primitive formals table
 
-  args = PROTECT(list2(ALIKEC_SYM_args, R_NilValue));
-  if(
-    tar_type == SPECIALSXP || tar_type == BUILTINSXP ||
-    cur_type == SPECIALSXP || cur_type == BUILTINSXP
-  ) {
-    SET_TYPEOF(args, LANGSXP);
-  }
-  if(tar_type == SPECIALSXP || tar_type == BUILTINSXP) {
-    SETCADR(args, target);
-    target = PROTECT(eval(args, R_BaseEnv));
-  } else PROTECT(R_NilValue);
+  SEXP tar_formals, cur_formals;
+  if(tar_type == SPECIALSXP || tar_type == BUILTINSXP)
+    tar_formals = ALIKEC_prim_formals(target);
+  else tar_formals = FORMALS(target);
 
-  if(cur_type == SPECIALSXP || cur_type == BUILTINSXP) {
-    SETCADR(args, current);
-    current = PROTECT(eval(args, R_BaseEnv));
-  } else PROTECT(R_NilValue);
+  if(cur_type == SPECIALSXP || cur_type == BUILTINSXP)
+    cur_formals = ALIKEC_prim_formals(current);
+  else cur_formals = FORMALS(current);
 
   // Cycle through all formals
 
@@ -76,7 +107,7 @@ struct ALIKEC_res ALIKEC_fun_alike_internal(
   SEXP last_match = R_NilValue, tar_tag, cur_tag;
 
   for(
-    tar_form = FORMALS(target), cur_form = FORMALS(current);
+    tar_form = tar_formals, cur_form = cur_formals;
     tar_form != R_NilValue && cur_form != R_NilValue;
     tar_form = CDR(tar_form), cur_form = CDR(cur_form), tar_args++
   ) {
@@ -156,7 +187,6 @@ struct ALIKEC_res ALIKEC_fun_alike_internal(
       res.dat.strings.target[2] = arg_type;
     }
   }
-  UNPROTECT(3);
   if(!res.success) res.wrap = allocVector(VECSXP, 2);
   return res;
 }
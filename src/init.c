@@ -18,11 +18,13 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 
 #include "validate.h"
 #include "all-bw.h"
+#include "pfhash.h"
 #include <R_ext/Rdynload.h>
 
 static const
 R_CallMethodDef callMethods[] = {
   {"validate", (DL_FUNC) &VALC_validate, 8},
+  {"validate_each", (DL_FUNC) &VALC_validate_each, 8},
   {"validate_args", (DL_FUNC) &VALC_validate_args, 5},
   {"name_sub", (DL_FUNC) &VALC_name_sub_ext, 2},
   {"symb_sub", (DL_FUNC) &VALC_sub_symbol_ext, 2},
@@ -32,8 +34,9 @@ R_CallMethodDef callMethods[] = {
   {"all", (DL_FUNC) &VALC_all_ext, 1},
   {"track_hash", (DL_FUNC) &VALC_track_hash_test, 2},
   {"default_hash_fun", (DL_FUNC) &VALC_default_hash_fun, 1},
-  {"all_bw", (DL_FUNC) &VALC_all_bw, 5},
+  {"all_bw", (DL_FUNC) &VALC_all_bw, 6},
   {"check_assumptions", (DL_FUNC) &VALC_check_assumptions, 0},
+  {"native_tokens_init", (DL_FUNC) &VALC_native_tokens_init, 1},
 
 /*
   {"test1", (DL_FUNC) &VALC_test1, 1},
@@ -41,6 +44,8 @@ R_CallMethodDef callMethods[] = {
   {"test3", (DL_FUNC) &VALC_test3, 3},
 */
   {"alike_ext", (DL_FUNC) &ALIKEC_alike_ext, 5},
+  {"alike_each_ext", (DL_FUNC) &ALIKEC_alike_each_ext, 5},
+  {"compile_template", (DL_FUNC) &ALIKEC_compile_template, 1},
   {"typeof", (DL_FUNC) &ALIKEC_typeof, 1},
   {"mode", (DL_FUNC) &ALIKEC_mode, 1},
   {"type_alike", (DL_FUNC) &ALIKEC_type_alike, 4},
@@ -101,6 +106,7 @@ SEXP VALC_SYM_one_dot;
 SEXP VALC_SYM_paren;
 SEXP VALC_SYM_current;
 SEXP VALC_SYM_errmsg;
+SEXP VALC_SYM_or_tpl;
 SEXP VALC_TRUE;
 SEXP ALIKEC_SYM_package;
 SEXP ALIKEC_SYM_inherits;
@@ -118,6 +124,7 @@ SEXP ALIKEC_SYM_attr;
 SEXP ALIKEC_SYM_colnames;
 SEXP ALIKEC_SYM_length;
 SEXP ALIKEC_SYM_syntacticnames;
+SEXP ALIKEC_SYM_template;
 
 void R_init_vetr(DllInfo *info)
 {
@@ -134,6 +141,7 @@ void R_init_vetr(DllInfo *info)
   VALC_SYM_paren = install("(");
   VALC_SYM_current = install("current");
   VALC_SYM_errmsg = install("err.msg");
+  VALC_SYM_or_tpl = install("or.tpl");
   VALC_TRUE = ScalarLogical(1);
 
   // Some overlap with previous since these used to be separate packages...
@@ -154,5 +162,6 @@ void R_init_vetr(DllInfo *info)
   ALIKEC_SYM_colnames = install("colnames");
   ALIKEC_SYM_length = install("length");
   ALIKEC_SYM_syntacticnames = install("syntacticnames");
+  ALIKEC_SYM_template = install("vetr_compiled_template");
 }
 
@@ -18,20 +18,17 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 
 #include "alike.h"
 
-/*
-Initialize return object
-*/
 /*
 Moves pointer on language object to skip any `(` calls since those are
 already accounted for in parsing and as such don't add anything.
 
-Returns a list/vector with a pointer to the updated lanaguage object position
-and an integer indicating how many parentheses were skipped
+Returns the updated language object position and sets `skipped` to how many
+parentheses were skipped.  Nothing is allocated so this is safe to use on every
+node we visit.
 */
 
-SEXP ALIKEC_skip_paren(SEXP lang) {
+static SEXP ALIKEC_skip_paren(SEXP lang, int * skipped) {
   int i = 0;
-  SEXP res = PROTECT(allocVector(VECSXP, 2));
   if(TYPEOF(lang) == LANGSXP) {
     while(
       CAR(lang) == ALIKEC_SYM_paren_open && CDR(CDR(lang)) == R_NilValue
@@ -47,10 +44,8 @@ SEXP ALIKEC_skip_paren(SEXP lang) {
         // nocov end
       }
   } }
-  SET_VECTOR_ELT(res, 0, lang);
-  SET_VECTOR_ELT(res, 1, ScalarInteger(i));
-  UNPROTECT(1);
-  return(res);
+  *skipped = i;
+  return lang;
 }
 
 // - Anonymize Formula ---------------------------------------------------------
@@ -58,24 +53,22 @@ SEXP ALIKEC_skip_paren(SEXP lang) {
 /* Look up symbol in hash table, if already present, return the anonymized
 version of the symbol.  If not, add to the hash table.
 
+Symbols are interned so we key the hash on the SYMSXP itself, and the
+anonymized version is just the (1 based) order in which the symbol first
+appeared, stored in place of the value pointer.
+
 symb the symbol to lookup
 hash the hash table
 varnum used to generate the anonymized variable name
 */
 
-const char * ALIKEC_symb_abstract(
-  SEXP symb, pfHashTable * hash, size_t * varnum, struct VALC_settings set
+static uintptr_t ALIKEC_symb_abstract(
+  SEXP symb, struct VALC_ptr_hash * hash, size_t * varnum
 ) {
-  const char * symb_chr = CHAR(PRINTNAME(symb));
-  // really shouldn't have to do this, but can't be bothered re-defining the
-  // hash library
-  const char * symb_abs = pfHashFind(hash, (char *) symb_chr);
-  if(symb_abs == NULL) {
-    symb_abs = CSR_smprintf4(
-      set.nchar_max, "a%s", CSR_len_as_chr(*varnum), "", "", ""
-    );
-    pfHashSet(hash, (char *) symb_chr, symb_abs);
-    (*varnum)++;
+  uintptr_t symb_abs = (uintptr_t) VALC_ptr_hash_find(hash, symb);
+  if(!symb_abs) {
+    symb_abs = (uintptr_t) ++(*varnum);
+    VALC_ptr_hash_set(hash, symb, (const void *) symb_abs);
   }
   return symb_abs;
 }
@@ -103,18 +96,13 @@ SEXP ALIKEC_get_fun(SEXP call, SEXP env) {
   return R_NilValue;
 }
 /*
-@param match_call a preconstructed call to retrieve the function; needed because
-  can't figure out a way to create preconstructed call in init without
-  sub-components getting GCed
+Run `match.call` in R
+
+@param fun the closure `call` is a call to
 */
-SEXP ALIKEC_match_call(
-  SEXP call, SEXP match_call, SEXP env
+static SEXP ALIKEC_match_call_eval(
+  SEXP call, SEXP fun, SEXP match_call, SEXP env
 ) {
-  SEXP fun = PROTECT(ALIKEC_get_fun(call, env));
-  if(fun == R_NilValue) {
-    UNPROTECT(1);
-    return call;
-  }
   // remember, match_call is pre-defined as: match.call(def, quote(call)), also,
   // in theory should never be SHARED since it is a SEXP created in C code only
   // for internal use.
@@ -127,45 +115,101 @@ SEXP ALIKEC_match_call(
   int tmp = 0;
   int * err =& tmp;
   SEXP res = PROTECT(R_tryEvalSilent(match_call, env, err));
-  UNPROTECT(3);
+  UNPROTECT(2);
   if(* err) return call; else return res;
 }
 /*
+@param match_call a preconstructed call to retrieve the function; needed because
+  can't figure out a way to create preconstructed call in init without
+  sub-components getting GCed
+*/
+SEXP ALIKEC_match_call(
+  SEXP call, SEXP match_call, SEXP env
+) {
+  SEXP fun = PROTECT(ALIKEC_get_fun(call, env));
+  SEXP res = call;
+  if(fun != R_NilValue) {
+    res = ALIKEC_match_call_fast(call, fun);
+    if(res == R_NilValue)
+      res = ALIKEC_match_call_eval(call, fun, match_call, env);
+  }
+  UNPROTECT(1);
+  return res;
+}
+/*
+Version of `ALIKEC_match_call` for use during language comparison.
+
+Functions are looked up once per symbol for each top level comparison, with the
+results kept in `fun_hash`.  Template calls are additionally looked up in, and
+added to, the matched template cache (see match-call.c).
+
+@param fun_hash symbol -> function, with R_NilValue for symbols that do not
+  resolve to closures
+@param fun_prot pairlist the closures in `fun_hash` are added to so they stay
+  protected for the duration of the comparison
+@param is_target whether `call` is part of the template
+*/
+static SEXP ALIKEC_match_call_memo(
+  SEXP call, SEXP match_call, SEXP env, struct VALC_ptr_hash * fun_hash,
+  SEXP fun_prot, int is_target
+) {
+  SEXP fun_sym = CAR(call), fun;
+  if(TYPEOF(fun_sym) == SYMSXP) {
+    fun = (SEXP) VALC_ptr_hash_find(fun_hash, fun_sym);
+    if(!fun) {
+      fun = ALIKEC_get_fun(call, env);
+      if(fun != R_NilValue) SETCDR(fun_prot, CONS(fun, CDR(fun_prot)));
+      VALC_ptr_hash_set(fun_hash, fun_sym, fun);
+    }
+  } else fun = ALIKEC_get_fun(call, env);
+
+  if(fun == R_NilValue) return call;
+  PROTECT(fun);
+
+  SEXP res = NULL;
+  if(is_target) res = ALIKEC_match_call_cache_get(call, fun);
+  if(!res) {
+    res = ALIKEC_match_call_fast(call, fun);
+    if(res == R_NilValue) {
+      res = ALIKEC_match_call_eval(call, fun, match_call, env);
+    }
+    if(is_target) {
+      PROTECT(res);
+      ALIKEC_match_call_cache_set(call, fun, res);
+      UNPROTECT(1);
+  } }
+  UNPROTECT(1);
+  return res;
+}
+/*
 Handle language object comparison
 
-Note that we always pass cur_par instead of current so that we can modify the
-original call (mostly by using `match.call` on it)
+Both `target` and `current` are walked in place; we never modify or copy them.
+The only record of where a failure happened is the recursion index in
+`res.dat.rec`, which is enough to rebuild `call.ind` against the matched call.
 */
 struct ALIKEC_res ALIKEC_lang_obj_compare(
-  SEXP target, SEXP cur_par, pfHashTable * tar_hash,
-  pfHashTable * cur_hash, pfHashTable * rev_hash, size_t * tar_varnum,
-  size_t * cur_varnum, int formula, SEXP match_call, SEXP match_env,
+  SEXP target, SEXP current, struct VALC_ptr_hash * tar_hash,
+  struct VALC_ptr_hash * cur_hash, struct VALC_ptr_hash * rev_hash,
+  struct VALC_ptr_hash * fun_hash, SEXP fun_prot,
+  size_t * tar_varnum, size_t * cur_varnum, int formula, SEXP match_call, SEXP match_env,
   struct VALC_settings set, struct ALIKEC_rec_track rec
 ) {
-  SEXP current = CAR(cur_par);
   struct ALIKEC_res res = ALIKEC_res_init();
   res.dat.rec = rec;
 
   // Skip parens and increment recursion; not we don't track recursion level
   // for target
 
-  SEXP cur_skip_paren = PROTECT(ALIKEC_skip_paren(current));
-  SEXP tar_skip_paren = PROTECT(ALIKEC_skip_paren(target));
-
-  // Need to reset all variables so we work on the paren less version
-
-  current = VECTOR_ELT(cur_skip_paren, 0);
-  SEXP cur_par_dup = PROTECT(duplicate(cur_par));
-  SETCAR(cur_par_dup, current);
-
-  int i, i_max = asInteger(VECTOR_ELT(cur_skip_paren, 1));
+  int i, i_max, tar_parens;
+  current = ALIKEC_skip_paren(current, &i_max);
+  target = ALIKEC_skip_paren(target, &tar_parens);
 
   PROTECT(res.wrap);   // Dummy PROTECT
 
   for(i = 0; i < i_max; i++) {
     res.dat.rec = ALIKEC_rec_inc(res.dat.rec);
   }
-  target = VECTOR_ELT(tar_skip_paren, 0);
 
   SEXPTYPE tsc_type = TYPEOF(target), csc_type = TYPEOF(current);
   res.success = 0;  // assume fail until shown otherwise
@@ -173,20 +217,17 @@ struct ALIKEC_res ALIKEC_lang_obj_compare(
   if(target == R_NilValue) {// NULL matches anything
     res.success = 1;
   } else if(tsc_type == SYMSXP && csc_type == SYMSXP) {
-    const char * tar_abs = ALIKEC_symb_abstract(
-      target, tar_hash, tar_varnum, set
-    );
-    const char * cur_abs = ALIKEC_symb_abstract(
-      current, cur_hash, cur_varnum, set
-    );
+    uintptr_t tar_abs = ALIKEC_symb_abstract(target, tar_hash, tar_varnum);
+    uintptr_t cur_abs = ALIKEC_symb_abstract(current, cur_hash, cur_varnum);
     // reverse hash to get what symbol should be in case of error
-    const char * rev_symb = pfHashFind(rev_hash, tar_abs);
+    const char * rev_symb =
+      (const char *) VALC_ptr_hash_find(rev_hash, (const void *) tar_abs);
     const char * csc_text = CHAR(PRINTNAME(current));
     if(rev_symb == NULL) {
-      rev_symb = (char *) csc_text;
-      pfHashSet(rev_hash, cur_abs, rev_symb);
+      rev_symb = csc_text;
+      VALC_ptr_hash_set(rev_hash, (const void *) cur_abs, rev_symb);
     }
-    if(strcmp(tar_abs, cur_abs)) {
+    if(tar_abs != cur_abs) {
       res.success = 0;
       if(*tar_varnum > *cur_varnum) {
         res.dat.strings.tar_pre = "not be";
@@ -213,12 +254,11 @@ struct ALIKEC_res ALIKEC_lang_obj_compare(
     res.dat.strings.current[0] =  "\"%s\"";
     res.dat.strings.current[1] = type2char(csc_type);
   } else if (tsc_type == LANGSXP) {
-    // Note how we pass cur_par and not current so we can modify cur_par
-    // this should be changed since we don't use that feature any more
     UNPROTECT(1);
     res = ALIKEC_lang_alike_rec(
-      target, cur_par_dup, tar_hash, cur_hash, rev_hash, tar_varnum,
-      cur_varnum, formula, match_call, match_env, set, res.dat.rec
+      target, current, R_NilValue, tar_hash, cur_hash, rev_hash, fun_hash,
+      fun_prot, tar_varnum, cur_varnum, formula, match_call, match_env, set,
+      res.dat.rec
     );
     PROTECT(res.wrap);
   } else if(tsc_type == SYMSXP || csc_type == SYMSXP) {
@@ -249,7 +289,7 @@ struct ALIKEC_res ALIKEC_lang_obj_compare(
     }
     if(res.wrap == R_NilValue) res.wrap = allocVector(VECSXP, 2);
   }
-  UNPROTECT(4);
+  UNPROTECT(1);
   return res;
 }
 
@@ -261,23 +301,21 @@ Here we use a hash table to identify whether a symbol already showed up or not.
 This is probably faster if langauge object has 25 or more elements, so may
 eventually want to add logic that choses path based on how many elements.
 
-If return value is zero length string then comparison succeeded, otherwise
-return value is error message.  Note that we also return information by modifying
-the `cur_par` argument by reference.  We either mark the token the error message
-refers to by wrapping it in ``{}``, or blow it away to indicate we don't want
-the final error message to try to point out where the error occurred (this is
-typically the case when the error is not specific to a particular part of the
-call).
+If the top level `current` is matched with `match.call`, the matched call is
+stored in `cur_par`, a pairlist created by `ALIKEC_lang_alike_core`, so it can be
+returned as `call.match`.  Nested calls pass R_NilValue for `cur_par` as the
+recursion indices for them are relative to the top level matched call.
+Neither `target` nor `current` are modified.
 */
 
 struct ALIKEC_res ALIKEC_lang_alike_rec(
-  SEXP target, SEXP cur_par, pfHashTable * tar_hash, pfHashTable * cur_hash,
-  pfHashTable * rev_hash, size_t * tar_varnum, size_t * cur_varnum, int formula,
+  SEXP target, SEXP current, SEXP cur_par, struct VALC_ptr_hash * tar_hash,
+  struct VALC_ptr_hash * cur_hash, struct VALC_ptr_hash * rev_hash,
+  struct VALC_ptr_hash * fun_hash, SEXP fun_prot,
+  size_t * tar_varnum, size_t * cur_varnum, int formula,
   SEXP match_call, SEXP match_env, struct VALC_settings set,
   struct ALIKEC_rec_track rec
 ) {
-  SEXP current = CAR(cur_par);
-
   // If not language object, run comparison
 
   struct ALIKEC_res res = ALIKEC_res_init();
@@ -285,8 +323,8 @@ struct ALIKEC_res ALIKEC_lang_alike_rec(
 
   if(TYPEOF(target) != LANGSXP || TYPEOF(current) != LANGSXP) {
     res =  ALIKEC_lang_obj_compare(
-      target, cur_par, tar_hash, cur_hash, rev_hash, tar_varnum,
-      cur_varnum, formula, match_call, match_env, set, res.dat.rec
+      target, current, tar_hash, cur_hash, rev_hash, fun_hash, fun_prot,
+      tar_varnum, cur_varnum, formula, match_call, match_env, set, res.dat.rec
     );
   } else {
     // If language object, then recurse
@@ -317,9 +355,18 @@ struct ALIKEC_res ALIKEC_lang_alike_rec(
 
       int use_names = 1;
       if(match_env != R_NilValue && set.lang_mode != 1) {
-        target = PROTECT(ALIKEC_match_call(target, match_call, match_env));
-        current = PROTECT(ALIKEC_match_call(current, match_call, match_env));
-        SETCAR(cur_par, current);  // ensures original call is matched
+        target = PROTECT(
+          ALIKEC_match_call_memo(
+            target, match_call, match_env, fun_hash, fun_prot, 1
+          )
+        );
+        current = PROTECT(
+          ALIKEC_match_call_memo(
+            current, match_call, match_env, fun_hash, fun_prot, 0
+          )
+        );
+        // ensures original call is matched
+        if(cur_par != R_NilValue) SETCAR(cur_par, current);
         // Can't be sure that names will match up with call as originally
         // submitted
         use_names = 0;
@@ -385,9 +432,9 @@ struct ALIKEC_res ALIKEC_lang_alike_rec(
 
           SEXP tar_sub_car = CAR(tar_sub);
           res = ALIKEC_lang_obj_compare(
-            tar_sub_car, cur_sub, tar_hash, cur_hash, rev_hash,
-            tar_varnum, cur_varnum, formula, match_call, match_env, set,
-            res.dat.rec
+            tar_sub_car, CAR(cur_sub), tar_hash, cur_hash, rev_hash, fun_hash,
+            fun_prot, tar_varnum, cur_varnum, formula, match_call, match_env,
+            set, res.dat.rec
           );
           update_rec_ind = 1;
         }
@@ -473,9 +520,12 @@ SEXP ALIKEC_lang_alike_core(
   through the language objects
   */
 
-  pfHashTable * tar_hash = pfHashCreate(NULL);
-  pfHashTable * cur_hash = pfHashCreate(NULL);
-  pfHashTable * rev_hash = pfHashCreate(NULL);
+  struct VALC_ptr_hash * tar_hash = VALC_ptr_hash_create(0);
+  struct VALC_ptr_hash * cur_hash = VALC_ptr_hash_create(0);
+  struct VALC_ptr_hash * rev_hash = VALC_ptr_hash_create(0);
+  struct VALC_ptr_hash * fun_hash = VALC_ptr_hash_create(0);
+  // keeps the closures in `fun_hash` protected
+  SEXP fun_prot = PROTECT(list1(R_NilValue));
   size_t tartmp = 0, curtmp=0;
   size_t * tar_varnum = &tartmp;
   size_t * cur_varnum = &curtmp;
@@ -502,14 +552,14 @@ SEXP ALIKEC_lang_alike_core(
     formula = 1;
   }
   UNPROTECT(1);
-  // Check if alike; originally we would modify a copy of current, which is
-  // why we send curr_cpy_par
+  // Check if alike; `current` is not modified, `curr_par` just collects the
+  // matched version of it for `call.match`
 
-  SEXP curr_cpy_par = PROTECT(list1(duplicate(current)));
+  SEXP curr_par = PROTECT(list1(current));
   struct ALIKEC_rec_track rec = ALIKEC_rec_track_init();
   struct ALIKEC_res res = ALIKEC_lang_alike_rec(
-    target, curr_cpy_par, tar_hash, cur_hash, rev_hash, tar_varnum, cur_varnum,
-    formula, match_call, match_env, set, rec
+    target, current, curr_par, tar_hash, cur_hash, rev_hash, fun_hash,
+    fun_prot, tar_varnum, cur_varnum, formula, match_call, match_env, set, rec
   );
   // Save our results in a SEXP to simplify testing
   const char * names[6] = {
@@ -540,13 +590,13 @@ SEXP ALIKEC_lang_alike_core(
     SET_VECTOR_ELT(res_fin, 1, res_msg);
     UNPROTECT(3);
 
-    SET_VECTOR_ELT(res_fin, 2, CAR(curr_cpy_par));
+    SET_VECTOR_ELT(res_fin, 2, CAR(curr_par));
     SET_VECTOR_ELT(res_fin, 3, VECTOR_ELT(rec_ind, 0));
     SET_VECTOR_ELT(res_fin, 4, VECTOR_ELT(rec_ind, 1));
     SET_VECTOR_ELT(res_fin, 5, current);
     UNPROTECT(1);
   }
-  UNPROTECT(4);
+  UNPROTECT(5);
   return res_fin;
 }
 /*
@@ -0,0 +1,168 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "alike.h"
+
+/*
+ * Argument matching for language comparisons
+ *
+ * Language comparison normalizes calls with `match.call` before comparing
+ * them.  Evaluating `match.call` from C for every call node is expensive, so:
+ *
+ * - `ALIKEC_match_call_fast` matches arguments natively in the simple cases,
+ *   i.e. exact tags and positional arguments for closures without `...` in
+ *   their formals.  Anything else (partial matching, `...`, empty arguments,
+ *   errors) is left to `match.call`.
+ * - Matched template calls are kept in a small direct mapped table keyed on the
+ *   template call and the closure it was matched against, since templates are
+ *   usually the same objects from one validation to the next.  Entries are
+ *   weak references keyed on the closure environment, with the template call,
+ *   the closure, and the matched call as the value.  R only keeps the value
+ *   alive while the environment is reachable from elsewhere, so the table does
+ *   not keep environments alive, and once an environment is collected the
+ *   entry key becomes R_NilValue so it can't be matched by a new object that
+ *   happens to reuse the memory.  A redefined function is a different closure
+ *   so the cache need not be invalidated.
+ * - Every weak reference R creates stays on its internal list until its key is
+ *   collected, so a slot is only given a new weak reference when it is empty
+ *   or its key was collected.  Entries for the environment already in the slot
+ *   are updated in place.  This bounds the number of live weak references to
+ *   the table size at the cost of some misses on slot collisions.
+ *
+ * Calls with `...` arguments are never cached since their expansion depends on
+ * the environment.
+ */
+
+#define ALIKEC_MC_MAX_FORMALS 64
+#define ALIKEC_MC_CACHE_SIZE 64  // must be a power of 2
+
+static SEXP ALIKEC_mc_cache = NULL;
+
+/*
+ * Whether `call` has `...` as one of its arguments
+ */
+static int ALIKEC_mc_has_dots(SEXP call) {
+  for(SEXP arg = CDR(call); arg != R_NilValue; arg = CDR(arg))
+    if(CAR(arg) == R_DotsSymbol) return 1;
+  return 0;
+}
+/*
+ * @param fun the closure `call` is a call to
+ * @return the matched call, or R_NilValue if we need `match.call` to match it
+ */
+SEXP ALIKEC_match_call_fast(SEXP call, SEXP fun) {
+  if(TYPEOF(fun) != CLOSXP || TYPEOF(call) != LANGSXP) return R_NilValue;
+
+  SEXP formal_tag[ALIKEC_MC_MAX_FORMALS];
+  SEXP arg_match[ALIKEC_MC_MAX_FORMALS];
+  int form_num = 0, i;
+
+  for(SEXP form = FORMALS(fun); form != R_NilValue; form = CDR(form)) {
+    if(TAG(form) == R_DotsSymbol || form_num == ALIKEC_MC_MAX_FORMALS)
+      return R_NilValue;
+    formal_tag[form_num] = TAG(form);
+    arg_match[form_num++] = R_NilValue;
+  }
+  // Exact tag matches first, then fill in remaining formals by position
+
+  int arg_num = 0;
+  for(SEXP arg = CDR(call); arg != R_NilValue; arg = CDR(arg)) {
+    SEXP tag = TAG(arg);
+    if(CAR(arg) == R_MissingArg || CAR(arg) == R_DotsSymbol) return R_NilValue;
+    ++arg_num;
+    if(tag == R_NilValue) continue;
+
+    for(i = 0; i < form_num && formal_tag[i] != tag; ++i);
+    if(i == form_num || arg_match[i] != R_NilValue) return R_NilValue;
+    arg_match[i] = arg;
+  }
+  if(arg_num > form_num) return R_NilValue;
+
+  i = 0;
+  for(SEXP arg = CDR(call); arg != R_NilValue; arg = CDR(arg)) {
+    if(TAG(arg) != R_NilValue) continue;
+    while(i < form_num && arg_match[i] != R_NilValue) ++i;
+    if(i == form_num) return R_NilValue;  // nocov, checked arg_num above
+    arg_match[i] = arg;
+  }
+  // Matched call lists arguments in the order of the formals
+
+  SEXP res = PROTECT(allocList(arg_num + 1));
+  SET_TYPEOF(res, LANGSXP);
+  SETCAR(res, CAR(call));
+  SEXP res_arg = CDR(res);
+  for(i = 0; i < form_num; ++i) {
+    if(arg_match[i] == R_NilValue) continue;
+    SETCAR(res_arg, CAR(arg_match[i]));
+    SET_TAG(res_arg, formal_tag[i]);
+    res_arg = CDR(res_arg);
+  }
+  UNPROTECT(1);
+  return res;
+}
+static R_xlen_t ALIKEC_mc_slot(SEXP call, SEXP fun) {
+  uintptr_t h = 2166136261U;
+  h = (h ^ ((uintptr_t) call >> 4)) * 16777619U;
+  h = (h ^ ((uintptr_t) fun >> 4)) * 16777619U;
+  return (R_xlen_t) ((h ^ (h >> 16)) & (ALIKEC_MC_CACHE_SIZE - 1));
+}
+/*
+ * @return the cached matched version of template `call`, or NULL if there is
+ *   none
+ */
+SEXP ALIKEC_match_call_cache_get(SEXP call, SEXP fun) {
+  if(!ALIKEC_mc_cache) return NULL;
+  SEXP slot = VECTOR_ELT(ALIKEC_mc_cache, ALIKEC_mc_slot(call, fun));
+  if(slot == R_NilValue || R_WeakRefKey(slot) != CLOENV(fun)) return NULL;
+
+  SEXP val = R_WeakRefValue(slot);
+  if(
+    val == R_NilValue ||
+    VECTOR_ELT(val, 0) != call || VECTOR_ELT(val, 1) != fun
+  )
+    return NULL;
+  return VECTOR_ELT(val, 2);
+}
+/*
+ * @param fun a closure, weak references can't be keyed on other function types
+ */
+void ALIKEC_match_call_cache_set(SEXP call, SEXP fun, SEXP matched) {
+  if(ALIKEC_mc_has_dots(call) || TYPEOF(fun) != CLOSXP) return;
+  if(!ALIKEC_mc_cache) {
+    ALIKEC_mc_cache = allocVector(VECSXP, ALIKEC_MC_CACHE_SIZE);
+    R_PreserveObject(ALIKEC_mc_cache);
+  }
+  R_xlen_t i = ALIKEC_mc_slot(call, fun);
+  SEXP slot = VECTOR_ELT(ALIKEC_mc_cache, i), val;
+  if(slot != R_NilValue) {
+    SEXP key = R_WeakRefKey(slot);
+    if(key == CLOENV(fun) && (val = R_WeakRefValue(slot)) != R_NilValue) {
+      SET_VECTOR_ELT(val, 0, call);
+      SET_VECTOR_ELT(val, 1, fun);
+      SET_VECTOR_ELT(val, 2, matched);
+      return;
+    } else if(key != R_NilValue) return;
+  }
+  val = PROTECT(allocVector(VECSXP, 3));
+  SET_VECTOR_ELT(val, 0, call);
+  SET_VECTOR_ELT(val, 1, fun);
+  SET_VECTOR_ELT(val, 2, matched);
+  slot = PROTECT(R_MakeWeakRef(CLOENV(fun), val, R_NilValue, FALSE));
+  SET_VECTOR_ELT(ALIKEC_mc_cache, i, slot);
+  UNPROTECT(2);
+}
@@ -99,9 +99,13 @@ SEXP ALIKEC_abstract_ts(SEXP x, SEXP attr) {
 /*
 Run deparse command and return character vector with results
 
-set width_cutoff to be less than zero to use default
+set width_cutoff to be less than zero to use default; simple objects are
+deparsed natively, see deparse.c
 */
 SEXP ALIKEC_deparse_core(SEXP obj, int width_cutoff) {
+  SEXP res_fast = ALIKEC_deparse_fast(obj, width_cutoff);
+  if(res_fast != R_NilValue) return res_fast;
+
   SEXP quot_call = PROTECT(list2(R_QuoteSymbol, obj));
   SEXP dep_call;
 
@@ -213,7 +217,6 @@ const char * ALIKEC_pad(
 
   if(lines < 0) lines = line_max;
 
-  char * res = "";
   const char * dep_prompt = "", * dep_continue = "";
 
   // Figure out what to use as prompt and continue
@@ -242,18 +245,18 @@ const char * ALIKEC_pad(
     pad_chr[i] = '\0';
     dep_prompt = dep_continue = (const char *) pad_chr;
   }
-  // Cycle through lines
+  // Cycle through lines, appending to the result
+
+  struct CSR_strbuf res;
+  CSR_strbuf_init(&res, 0, set.nchar_max);
 
   for(i = 0; i < lines; i++) {
-    const char * dep_pad = "";
-    const char * dep_err = CHAR(STRING_ELT(obj, i));
-    if(!i) dep_pad = dep_prompt; else dep_pad = dep_continue;
-    res = CSR_smprintf6(
-      set.nchar_max, "%s%s%s%s%s%s", res, dep_pad, dep_err,
-      i == lines - 1 && lines < line_max ? "..." : "",
-      lines > 1 && line_max > 1 ? "\n" : "", ""
-  );}
-  return res;
+    CSR_strbuf_add(&res, i ? dep_continue : dep_prompt);
+    CSR_strbuf_add(&res, CHAR(STRING_ELT(obj, i)));
+    if(i == lines - 1 && lines < line_max) CSR_strbuf_add(&res, "...");
+    if(lines > 1 && line_max > 1) CSR_strbuf_add(&res, "\n");
+  }
+  return res.buf;
 }
 SEXP ALIKEC_pad_ext(SEXP obj, SEXP lines, SEXP pad) {
   struct VALC_settings set = VALC_settings_init();
@@ -529,9 +532,6 @@ SEXP ALIKEC_res_as_string(
 ) {
   const char * res_str = "<UNINITSTRING>";
   if(!res.success) {
-    struct ALIKEC_tar_cur_strings strings_pasted =
-      ALIKEC_get_res_strings(res.dat.strings, set);
-
     if(TYPEOF(res.wrap) != VECSXP || xlength(res.wrap) != 2) {
       // nocov start
       error(
@@ -546,21 +546,32 @@ SEXP ALIKEC_res_as_string(
     const char * call_chr = call_res.chr;
     UNPROTECT(1);
 
-    const char * extra_blank = "";
-    if(!call_res.multi_line) extra_blank = " ";
-    if(strings_pasted.target[0] && strings_pasted.current[0]) {
-      res_str = CSR_smprintf6(
-        set.nchar_max,
-        "%s%sshould %s %s (%s %s)",
-        call_chr, extra_blank, res.dat.strings.tar_pre, strings_pasted.target,
-        res.dat.strings.cur_pre, strings_pasted.current
-      );
-    } else if (res.dat.strings.target[0]) {
-      res_str = CSR_smprintf4(
-        set.nchar_max, "%s%sshould %s %s", call_chr, extra_blank,
-        res.dat.strings.tar_pre, strings_pasted.target
-      );
+    // Assemble "<call> should <tar_pre> <target> (<cur_pre> <current>)" in
+    // one buffer, substituting the target and current strings directly into
+    // it, and dropping the parenthetical if the current string is empty
+
+    struct ALIKEC_res_strings strings = res.dat.strings;
+    struct CSR_strbuf buf;
+    CSR_strbuf_init(&buf, 0, set.nchar_max);
+    CSR_strbuf_add(&buf, call_chr);
+    if(!call_res.multi_line) CSR_strbuf_add(&buf, " ");
+    CSR_strbuf_add(&buf, "should ");
+    CSR_strbuf_add(&buf, strings.tar_pre);
+    CSR_strbuf_add(&buf, " ");
+
+    size_t tar_start = buf.len;
+    CSR_strbuf_fmt(&buf, strings.target[0], strings.target + 1, 4);
+    if(buf.len > tar_start) {
+      size_t cur_mark = buf.len;
+      CSR_strbuf_add(&buf, " (");
+      CSR_strbuf_add(&buf, strings.cur_pre);
+      CSR_strbuf_add(&buf, " ");
+      size_t cur_start = buf.len;
+      CSR_strbuf_fmt(&buf, strings.current[0], strings.current + 1, 4);
+      if(buf.len > cur_start) CSR_strbuf_add(&buf, ")");
+      else buf.buf[buf.len = cur_mark] = '\0';
     }
+    if(buf.len > tar_start || strings.target[0][0]) res_str = buf.buf;
   } else
     error("Internal Error: res_as_string only works with fail res."); // nocov
   return(mkString(res_str));
@@ -0,0 +1,179 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "validate.h"
+
+/*
+ * Cache for parsed vetting tokens.
+ *
+ * `VALC_parse` duplicates the token twice, builds two tracking hashes, and
+ * walks the whole token, yet for a function that uses `vetr` the token never
+ * changes from call to call.  Here we keep the result of previous parses in a
+ * small direct mapped table so that we can skip all that work.
+ *
+ * The result of a parse depends on:
+ *
+ * - The token itself.
+ * - The parameter name (`arg_tag`), which replaces `.` in `lang`.
+ * - The substituted argument (`var_name`), which replaces `.` in `lang2`.
+ * - Whatever the symbols in the token resolved to in `set.env` at the time of
+ *   the parse, as symbols that resolve to language are substituted in.
+ *
+ * The first three are part of the key.  For the last one we record every
+ * symbol `VALC_sub_symbol` looks up along with what it resolved to, and on
+ * every cache hit we look them up again.  If any of them resolves to something
+ * different (e.g. it was rebound to a different language object, or it used to
+ * be unbound and now is not) we re-parse.  Note that symbols that resolve to
+ * non-language values are recorded only as such since the actual value does not
+ * affect the parse.  Re-resolving the symbols has the same side effects as the
+ * original parse (e.g. forcing promises).
+ *
+ * Each slot is a VECSXP of length `VALC_PC_LEN`.  The parse results in the
+ * cache are shared across calls, which is fine since nothing downstream of
+ * `VALC_parse` modifies the parsed language.  The only thing that is modified
+ * is the `||` dispatch hints (see `VALC_or_tpl_index`), and those are meant to
+ * carry over from call to call.
+ */
+
+#define VALC_PC_SIZE 256   // must be a power of 2
+#define VALC_PC_TOKEN 0
+#define VALC_PC_ARG_TAG 1
+#define VALC_PC_VAR_NAME 2
+#define VALC_PC_SET 3
+#define VALC_PC_DEPS 4
+#define VALC_PC_PARSED 5
+#define VALC_PC_LEN 6
+
+static SEXP VALC_parse_cache = NULL;
+
+/*
+ * Cheap structural hash of a token, used only to pick a slot so does not need
+ * to be precise; symbols (the bulk of what is in tokens) are unique so we can
+ * use their addresses.
+ */
+static uintptr_t VALC_parse_cache_hash(SEXP x, uintptr_t h, int depth) {
+  h = (h ^ (uintptr_t) TYPEOF(x)) * 16777619U;
+  if(depth > 64) return h;
+
+  switch(TYPEOF(x)) {
+    case SYMSXP: h = (h ^ ((uintptr_t) x >> 4)) * 16777619U; break;
+    case LANGSXP:
+    case LISTSXP:
+      for(; x != R_NilValue; x = CDR(x)) {
+        h = VALC_parse_cache_hash(CAR(x), h, depth + 1);
+        if(TAG(x) != R_NilValue)
+          h = (h ^ ((uintptr_t) TAG(x) >> 4)) * 16777619U;
+      }
+      break;
+    case LGLSXP:
+    case INTSXP:
+    case REALSXP:
+    case STRSXP:
+    case VECSXP:
+      h = (h ^ (uintptr_t) XLENGTH(x)) * 16777619U;
+      break;
+    default: break;
+  }
+  return h;
+}
+static int VALC_parse_cache_same(SEXP a, SEXP b) {
+  return a == b || R_compute_identical(a, b, 16);
+}
+/*
+ * Check whether all the symbols a parse depended on still resolve to the same
+ * thing in `rho`; see `VALC_sub_symbol` for how `deps` is generated.
+ */
+static int VALC_parse_cache_deps_valid(SEXP deps, SEXP rho) {
+  for(; deps != R_NilValue; deps = CDR(deps)) {
+    SEXP symb = TAG(deps), dep_val = CAR(deps), cur_val = R_UnboundValue;
+    int valid;
+
+    if(findVar(symb, rho) != R_UnboundValue) {
+      cur_val = PROTECT(eval(symb, rho));
+      if(TYPEOF(cur_val) != LANGSXP && TYPEOF(cur_val) != SYMSXP) {
+        valid = dep_val == R_NilValue;
+      } else {
+        valid = dep_val != R_NilValue && dep_val != R_UnboundValue &&
+          VALC_parse_cache_same(dep_val, cur_val);
+      }
+      UNPROTECT(1);
+    } else valid = dep_val == R_UnboundValue;
+
+    if(!valid) return 0;
+  }
+  return 1;
+}
+/*
+ * Drop in replacement for `VALC_parse` that uses previously cached results when
+ * they are still valid.
+ */
+SEXP VALC_parse_cached(
+  SEXP lang, SEXP var_name, struct VALC_settings set, SEXP arg_tag
+) {
+  if(!VALC_parse_cache) {
+    VALC_parse_cache = allocVector(VECSXP, VALC_PC_SIZE);
+    R_PreserveObject(VALC_parse_cache);
+  }
+  uintptr_t h = VALC_parse_cache_hash(lang, 2166136261U, 0);
+  h = VALC_parse_cache_hash(var_name, h, 0);
+  h = (h ^ ((uintptr_t) arg_tag >> 4)) * 16777619U;
+  R_xlen_t slot_i = (R_xlen_t) ((h ^ (h >> 16)) & (VALC_PC_SIZE - 1));
+
+  // Checking the dependencies can evaluate arbitrary code (e.g. promises) that
+  // could itself use the cache and evict this slot, so protect it
+
+  SEXP slot = PROTECT(VECTOR_ELT(VALC_parse_cache, slot_i));
+
+  if(
+    slot != R_NilValue &&
+    VECTOR_ELT(slot, VALC_PC_ARG_TAG) == arg_tag &&
+    INTEGER(VECTOR_ELT(slot, VALC_PC_SET))[0] == (int) set.nchar_max &&
+    INTEGER(VECTOR_ELT(slot, VALC_PC_SET))[1] ==
+      (int) set.track_hash_content_size &&
+    VALC_parse_cache_same(VECTOR_ELT(slot, VALC_PC_TOKEN), lang) &&
+    VALC_parse_cache_same(VECTOR_ELT(slot, VALC_PC_VAR_NAME), var_name) &&
+    VALC_parse_cache_deps_valid(
+      CDR(VECTOR_ELT(slot, VALC_PC_DEPS)), set.env
+    )
+  ) {
+    UNPROTECT(1);
+    return VECTOR_ELT(slot, VALC_PC_PARSED);
+  }
+  UNPROTECT(1);
+
+  // Cache miss, parse and record the symbols the parse depended on
+
+  SEXP deps = PROTECT(CONS(R_NilValue, R_NilValue));
+  SEXP parsed =
+    PROTECT(VALC_parse_int(lang, var_name, set, arg_tag, deps, 1));
+
+  slot = PROTECT(allocVector(VECSXP, VALC_PC_LEN));
+  SEXP set_key = allocVector(INTSXP, 2);
+  SET_VECTOR_ELT(slot, VALC_PC_SET, set_key);
+  INTEGER(set_key)[0] = (int) set.nchar_max;
+  INTEGER(set_key)[1] = (int) set.track_hash_content_size;
+  SET_VECTOR_ELT(slot, VALC_PC_TOKEN, lang);
+  SET_VECTOR_ELT(slot, VALC_PC_ARG_TAG, arg_tag);
+  SET_VECTOR_ELT(slot, VALC_PC_VAR_NAME, var_name);
+  SET_VECTOR_ELT(slot, VALC_PC_DEPS, deps);
+  SET_VECTOR_ELT(slot, VALC_PC_PARSED, parsed);
+  SET_VECTOR_ELT(VALC_parse_cache, slot_i, slot);
+
+  UNPROTECT(3);
+  return parsed;
+}
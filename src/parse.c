@@ -140,10 +140,14 @@ get out of sync in how we use them.
   single variable name, allows us to verify that we're not accidentally
   referencing the variable name in a vetting token that is supposed to be a
   standard token.
+@param deps either R_NilValue, or a pairlist cell to the CDR of which we
+  prepend every symbol we look up (as the TAG), along with what it resolved to
+  (as the CAR).  This is what allows the parse cache to tell whether a cached
+  parse is still valid (see `VALC_parse_cache_deps_valid`).
 */
 SEXP VALC_sub_symbol(
   SEXP lang, struct VALC_settings set, struct track_hash * track_hash,
-  SEXP arg_tag
+  SEXP arg_tag, SEXP deps
 ) {
   int check_arg_tag = TYPEOF(arg_tag) == SYMSXP;
   SEXP rho = set.env;
@@ -166,9 +170,7 @@ SEXP VALC_sub_symbol(
       );
     }
     const char * symb_chr = CHAR(PRINTNAME(lang));
-    int symb_stored = VALC_add_to_track_hash(
-      track_hash, symb_chr, "42", set.nchar_max
-    );
+    int symb_stored = VALC_add_to_track_hash(track_hash, lang);
 
     if(!symb_stored) {
       error(
@@ -181,14 +183,25 @@ SEXP VALC_sub_symbol(
       );
     }
     int var_found_resolves_symbol = 0;
+    SEXP dep_val = R_UnboundValue;
+    SEXP lang_orig = lang;
     if(findVar(lang, rho) != R_UnboundValue) {
       SEXP found_val = PROTECT(eval(lang, rho));
       SEXPTYPE found_val_type = TYPEOF(found_val);
+      dep_val = R_NilValue;
       if(found_val_type == LANGSXP || found_val_type == SYMSXP) {
+        dep_val = found_val;
         REPROTECT(lang = duplicate(found_val), ipx);
       }
       var_found_resolves_symbol = found_val_type == SYMSXP;
+      if(deps != R_NilValue) {
+        SETCDR(deps, CONS(dep_val, CDR(deps)));
+        SET_TAG(CDR(deps), lang_orig);
+      }
       UNPROTECT(1);
+    } else if(deps != R_NilValue) {
+      SETCDR(deps, CONS(dep_val, CDR(deps)));
+      SET_TAG(CDR(deps), lang_orig);
     }
     if(!var_found_resolves_symbol) break;
   }
@@ -198,10 +211,62 @@ SEXP VALC_sub_symbol(
 SEXP VALC_sub_symbol_ext(SEXP lang, SEXP rho) {
   struct track_hash * track_hash = VALC_create_track_hash(64);
   struct VALC_settings set = VALC_settings_vet(R_NilValue, rho);
-  return VALC_sub_symbol(lang, set, track_hash, R_NilValue);
+  return VALC_sub_symbol(lang, set, track_hash, R_NilValue, R_NilValue);
 }
 /* -------------------------------------------------------------------------- *\
 \* -------------------------------------------------------------------------- */
+/*
+ * Number of templates in the `||` chain with parse codes `codes`, or -1 if
+ * any of the alternatives is not a template.
+ */
+static R_xlen_t VALC_or_tpl_count(SEXP codes) {
+  int is_list = TYPEOF(codes) == LISTSXP;
+  int code = asInteger(is_list ? CAR(codes) : codes);
+  if(code == 999) return 1;
+  if(code != 2 || !is_list) return -1;
+
+  R_xlen_t count = 0;
+  for(codes = CDR(codes); codes != R_NilValue; codes = CDR(codes)) {
+    R_xlen_t sub = VALC_or_tpl_count(CAR(codes));
+    if(sub < 0) return -1;
+    count += sub;
+  }
+  return count;
+}
+/*
+ * Attach a dispatch table to the top of each long `||` chain of templates, as
+ * the "or.tpl" attribute of the chain's parse code.
+ *
+ * The table has the SEXPTYPE and the first class of the value each template
+ * produced the last time it was evaluated, in the order the templates appear
+ * in the chain.  These start off unknown and are filled in by
+ * `VALC_evaluate_recurse`, which uses them to try first the templates that
+ * could match the object being validated.
+ */
+static void VALC_or_tpl_index(SEXP codes) {
+  if(TYPEOF(codes) != LISTSXP) return;
+  int code = asInteger(CAR(codes));
+
+  if(code == 2) {
+    R_xlen_t count = VALC_or_tpl_count(codes);
+    if(count >= VALC_OR_TPL_MIN) {
+      SEXP tbl = PROTECT(allocVector(VECSXP, 2));
+      SEXP types = allocVector(INTSXP, count);
+      SET_VECTOR_ELT(tbl, 0, types);
+      SEXP klass = allocVector(STRSXP, count);
+      SET_VECTOR_ELT(tbl, 1, klass);
+      for(R_xlen_t i = 0; i < count; ++i) {
+        INTEGER(types)[i] = VALC_OR_KEY_UNKNOWN;
+        SET_STRING_ELT(klass, i, NA_STRING);
+      }
+      setAttrib(CAR(codes), VALC_SYM_or_tpl, tbl);
+      UNPROTECT(1);
+      return;
+  } }
+  if(code == 1 || code == 2)
+    for(codes = CDR(codes); codes != R_NilValue; codes = CDR(codes))
+      VALC_or_tpl_index(CAR(codes));
+}
 /*
  * Parse Validator Language
  *
@@ -212,10 +277,15 @@ SEXP VALC_sub_symbol_ext(SEXP lang, SEXP rho) {
  *
  * @param arg_tag the parameter name being validated, apparently `var_name` is
  *   the full substituted call, not just the symbol.
+ * @param deps see `VALC_sub_symbol`
+ * @param native whether to record predefined tokens that have native
+ *   implementations with their special codes (see tokens.c) instead of parsing
+ *   them as standard tokens.
  */
 
-SEXP VALC_parse(
-  SEXP lang, SEXP var_name, struct VALC_settings set, SEXP arg_tag
+SEXP VALC_parse_int(
+  SEXP lang, SEXP var_name, struct VALC_settings set, SEXP arg_tag, SEXP deps,
+  int native
 ) {
   SEXP lang_cpy, lang2_cpy, res, res_vec, rem_res;
   int mode;
@@ -254,10 +324,13 @@ SEXP VALC_parse(
   if(lang_cpy == VALC_SYM_one_dot) mode = 2;
   lang_cpy = PROTECT(VALC_name_sub(lang_cpy, arg_tag));
   lang2_cpy = PROTECT(VALC_name_sub(lang2_cpy, var_name));
+  SEXP lang_symb = lang_cpy;
 
   if(mode != 2) {
-    lang_cpy = PROTECT(VALC_sub_symbol(lang_cpy, set, track_hash, arg_tag));
-    lang2_cpy = PROTECT(VALC_sub_symbol(lang2_cpy, set, track_hash2, arg_tag));
+    lang_cpy =
+      PROTECT(VALC_sub_symbol(lang_cpy, set, track_hash, arg_tag, deps));
+    lang2_cpy =
+      PROTECT(VALC_sub_symbol(lang2_cpy, set, track_hash2, arg_tag, deps));
   } else PROTECT(PROTECT(R_NilValue));
 
   if(TYPEOF(lang_cpy) != LANGSXP) {
@@ -267,8 +340,22 @@ SEXP VALC_parse(
     // lang_cpy, res, are modified internally
     VALC_parse_recurse(
       lang_cpy, lang2_cpy, res, var_name, mode, R_NilValue, set, track_hash,
-      track_hash2, arg_tag
+      track_hash2, arg_tag, deps, native
     );
+    // Native tokens still need the recursion to substitute `.` in case we have
+    // to fall back to evaluating them in R, but get their own code
+
+    int native_code = 0;
+    if(native && !mode)
+      native_code = VALC_native_token_code(lang_symb, set.env);
+    if(native_code) {
+      UNPROTECT(1);
+      res = PROTECT(ScalarInteger(native_code));
+    }
+    // Dispatch tables are only of use for evaluation, which always goes
+    // through the `native` parse
+
+    if(native) VALC_or_tpl_index(res);
   }
   res_vec = PROTECT(allocVector(VECSXP, 3));
   SET_VECTOR_ELT(res_vec, 0, lang_cpy);
@@ -277,6 +364,11 @@ SEXP VALC_parse(
   UNPROTECT(9);
   return(res_vec);
 }
+SEXP VALC_parse(
+  SEXP lang, SEXP var_name, struct VALC_settings set, SEXP arg_tag
+) {
+  return VALC_parse_int(lang, var_name, set, arg_tag, R_NilValue, 0);
+}
 SEXP VALC_parse_ext(SEXP lang, SEXP var_name, SEXP rho) {
   struct VALC_settings set = VALC_settings_vet(R_NilValue, rho);
   return VALC_parse(lang, var_name, set, R_NilValue);
@@ -308,7 +400,7 @@ void VALC_parse_recurse(
   SEXP lang, SEXP lang2, SEXP lang_track, SEXP var_name, int eval_as_is,
   SEXP first_fun, struct VALC_settings set,
   struct track_hash * track_hash, struct track_hash * track_hash2,
-  SEXP arg_tag
+  SEXP arg_tag, SEXP deps, int native
 ) {
   /*
   If the object is not a language list, then return it, as part of an R vector
@@ -353,6 +445,7 @@ void VALC_parse_recurse(
     }
   }
   SETCAR(lang_track, ScalarInteger(call_type));     // Track type of call
+  int lang_call_type = call_type;
 
   if(first_fun == R_NilValue && call_type >= 10) {
     // First time we're no longer parsing && / ||, record so that we can then
@@ -397,11 +490,13 @@ void VALC_parse_recurse(
 
     size_t substitute_level = track_hash->idx;
     size_t substitute_level2 = track_hash2->idx;
+    SEXP lang_car_symb = lang_car;
 
     if(!is_one_dot) {
-      lang_car = PROTECT(VALC_sub_symbol(lang_car, set, track_hash, arg_tag));
+      lang_car =
+        PROTECT(VALC_sub_symbol(lang_car, set, track_hash, arg_tag, deps));
       lang2_car =
-        PROTECT(VALC_sub_symbol(lang2_car, set, track_hash2, arg_tag));
+        PROTECT(VALC_sub_symbol(lang2_car, set, track_hash2, arg_tag, deps));
     } else {
       PROTECT(PROTECT(R_NilValue));  // stack balance
     }
@@ -415,8 +510,17 @@ void VALC_parse_recurse(
 
       VALC_parse_recurse(
         lang_car, lang2_car, CAR(lang_track), var_name, eval_as_is_internal,
-        first_fun, set, track_hash, track_hash2, arg_tag
+        first_fun, set, track_hash, track_hash2, arg_tag, deps, native
       );
+      // Predefined tokens with native implementations are only recognized as
+      // direct operands of `&&` / `||` since otherwise they are just part of a
+      // larger expression.  We still recurse so that `.` is substituted in
+      // case we need to fall back to evaluating in R.
+
+      if(native && lang_call_type < 10 && !eval_as_is_internal) {
+        int native_code = VALC_native_token_code(lang_car_symb, set.env);
+        if(native_code) SETCAR(lang_track, ScalarInteger(native_code));
+      }
     } else {
       // Problem we have here is that we do not want to reset to 999 yet
       if(is_one_dot || eval_as_is_internal) {
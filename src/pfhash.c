@@ -33,6 +33,9 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 
 #include "pfhash.h"
 
+// Symbol tracking now uses the pointer keyed hash in ptrhash.c; this string
+// keyed table is only used by the internal testing functions below.
+
 // Simple hash function from K&R.
 
 // static uint32_t defaultFnKnR (char *key) {
@@ -0,0 +1,165 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "ptrhash.h"
+
+/*
+ * Pointer keyed hash table
+ *
+ * Replaces `pfHashTable` (see pfhash.c) for uses where the keys are interned
+ * R objects.  Comparing keys by pointer avoids hashing and copying strings,
+ * and with linear probing and power of two growth lookups remain O(1)
+ * regardless of how many symbols we track.
+ *
+ * Memory is allocated with `R_alloc` so it is released at the end of the
+ * `.Call`; on growth the old arrays are simply abandoned.
+ */
+
+#define VALC_PH_SIZE_MIN 16
+
+static size_t VALC_ptr_hash_slot(const void * key, size_t size) {
+  // Finalizer from splitmix64; low pointer bits are mostly zero due to
+  // alignment so we need to mix in the high bits
+
+  uint64_t h = (uint64_t) (uintptr_t) key;
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return (size_t) h & (size - 1);
+}
+static void VALC_ptr_hash_alloc(struct VALC_ptr_hash * hash, size_t size) {
+  hash->keys = (const void **) R_alloc(size, sizeof(void *));
+  hash->vals = (const void **) R_alloc(size, sizeof(void *));
+  hash->size = size;
+  VALC_ptr_hash_reset(hash);
+}
+struct VALC_ptr_hash * VALC_ptr_hash_create(size_t size_init) {
+  size_t size = VALC_PH_SIZE_MIN;
+  // Keep the load factor at or below 1/2
+  while(size < size_init * 2) size *= 2;
+
+  struct VALC_ptr_hash * hash =
+    (struct VALC_ptr_hash *) R_alloc(1, sizeof(struct VALC_ptr_hash));
+  VALC_ptr_hash_alloc(hash, size);
+  return hash;
+}
+/*
+ * Remove all entries, but keep the memory for re-use
+ */
+void VALC_ptr_hash_reset(struct VALC_ptr_hash * hash) {
+  for(size_t i = 0; i < hash->size; ++i) hash->keys[i] = NULL;
+  hash->count = 0;
+}
+/*
+ * @return the slot holding `key`, or the empty slot where it would go
+ */
+static size_t VALC_ptr_hash_locate(
+  struct VALC_ptr_hash * hash, const void * key
+) {
+  size_t mask = hash->size - 1;
+  size_t i = VALC_ptr_hash_slot(key, hash->size);
+  while(hash->keys[i] && hash->keys[i] != key) i = (i + 1) & mask;
+  return i;
+}
+/*
+ * @return the value associated with `key`, or NULL if `key` is not present
+ */
+const void * VALC_ptr_hash_find(
+  struct VALC_ptr_hash * hash, const void * key
+) {
+  size_t i = VALC_ptr_hash_locate(hash, key);
+  return hash->keys[i] ? hash->vals[i] : NULL;
+}
+/*
+ * Make sure the table can hold `count` entries without growing
+ */
+void VALC_ptr_hash_reserve(struct VALC_ptr_hash * hash, size_t count) {
+  if(count > SIZE_MAX / 4)
+    error("Internal Error: hash table too large; contact maintainer."); // nocov
+  if(count * 2 <= hash->size) return;
+
+  const void ** keys = hash->keys;
+  const void ** vals = hash->vals;
+  size_t size_old = hash->size, size = size_old;
+  while(size < count * 2) size *= 2;
+
+  VALC_ptr_hash_alloc(hash, size);
+  for(size_t j = 0; j < size_old; ++j) {
+    if(keys[j]) {
+      size_t k = VALC_ptr_hash_locate(hash, keys[j]);
+      hash->keys[k] = keys[j];
+      hash->vals[k] = vals[j];
+      ++hash->count;
+  } }
+}
+/*
+ * Set a value, creating the entry if it doesn't already exist
+ *
+ * @return 1 if the key already existed, 0 otherwise (same as `pfHashSet`)
+ */
+int VALC_ptr_hash_set(
+  struct VALC_ptr_hash * hash, const void * key, const void * val
+) {
+  if(!key)
+    error("Internal Error: NULL hash key; contact maintainer.");  // nocov
+
+  size_t i = VALC_ptr_hash_locate(hash, key);
+  if(hash->keys[i]) {
+    hash->vals[i] = val;
+    return 1;
+  }
+  if((hash->count + 1) * 2 > hash->size) {
+    VALC_ptr_hash_reserve(hash, hash->size);  // doubles size
+    i = VALC_ptr_hash_locate(hash, key);
+  }
+  hash->keys[i] = key;
+  hash->vals[i] = val;
+  ++hash->count;
+  return 0;
+}
+/*
+ * Delete an entry
+ *
+ * Following entries in the same probe run are shifted back so that lookups
+ * never need tombstones.
+ *
+ * @return 0 on success, -1 if `key` was not found (same as `pfHashDel`)
+ */
+int VALC_ptr_hash_del(struct VALC_ptr_hash * hash, const void * key) {
+  size_t mask = hash->size - 1;
+  size_t i = VALC_ptr_hash_locate(hash, key);
+  if(!hash->keys[i]) return -1;
+
+  size_t j = i;
+  while(1) {
+    j = (j + 1) & mask;
+    if(!hash->keys[j]) break;
+    size_t home = VALC_ptr_hash_slot(hash->keys[j], hash->size);
+    // Can move `j` into the hole at `i` only if its home slot is not in the
+    // cyclic range (i, j]
+    if(i <= j ? (i < home && home <= j) : (i < home || home <= j)) continue;
+    hash->keys[i] = hash->keys[j];
+    hash->vals[i] = hash->vals[j];
+    i = j;
+  }
+  hash->keys[i] = NULL;
+  --hash->count;
+  return 0;
+}
@@ -0,0 +1,50 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include <R.h>
+#include <Rinternals.h>
+#include <stdint.h>
+
+#ifndef _PTR_HASH_H
+#define _PTR_HASH_H
+
+  /*
+   * Open addressing hash table keyed on pointers (e.g. SYMSXPs or CHARSXPs,
+   * which R interns so that pointer equality is string equality).  `keys`
+   * and `vals` have `size` slots, `size` a power of two, and a NULL key marks
+   * an empty slot.
+   */
+
+  struct VALC_ptr_hash {
+    const void ** keys;
+    const void ** vals;
+    size_t size;
+    size_t count;
+  };
+  struct VALC_ptr_hash * VALC_ptr_hash_create(size_t size_init);
+  const void * VALC_ptr_hash_find(
+    struct VALC_ptr_hash * hash, const void * key
+  );
+  int VALC_ptr_hash_set(
+    struct VALC_ptr_hash * hash, const void * key, const void * val
+  );
+  int VALC_ptr_hash_del(struct VALC_ptr_hash * hash, const void * key);
+  void VALC_ptr_hash_reset(struct VALC_ptr_hash * hash);
+  void VALC_ptr_hash_reserve(struct VALC_ptr_hash * hash, size_t count);
+
+#endif
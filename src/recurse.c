@@ -119,6 +119,41 @@ struct ALIKEC_rec_track ALIKEC_rec_dec(struct ALIKEC_rec_track rec) {
   return rec;
 }
 /*
+Release scratch memory used by sub-comparisons
+
+Scratch memory comes from `R_alloc`, which is normally only released when the
+`.Call` returns, so comparing a list with many elements accumulates memory for
+every element compared.  Since successful sub-comparisons leave nothing
+behind that we need, we mark the `R_alloc` stack before each one and release
+it afterwards, which keeps memory use proportional to recursion depth.
+
+The exception is the environment tracking hash, which is created or grown on
+demand and must survive for the rest of the comparison; if that happened we
+keep the memory.  Never release after a failure as the recursion indices and
+error strings are allocated on the stack.
+*/
+struct ALIKEC_rec_mark ALIKEC_rec_mark(struct ALIKEC_rec_track rec) {
+  return (struct ALIKEC_rec_mark) {
+    .vmax = vmaxget(),
+    .envs = rec.envs,
+    .env_keys = rec.envs ? rec.envs->env_hash->hash->keys : 0,
+    .env_log = rec.envs ? rec.envs->env_hash->contents : 0
+  };
+}
+void ALIKEC_rec_release(
+  struct ALIKEC_rec_mark mark, struct ALIKEC_rec_track rec
+) {
+  if(
+    rec.envs == mark.envs &&
+    (
+      !rec.envs || (
+        rec.envs->env_hash->hash->keys == mark.env_keys &&
+        rec.envs->env_hash->contents == mark.env_log
+    ) )
+  )
+    vmaxset(mark.vmax);
+}
+/*
 Closely related to ALIKEC_rec_ind_as_chr except that it return a list (vector)
 with the language call with all the indices subset, and the pointer to the
 location in the language call that needs to be substituted.
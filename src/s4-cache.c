@@ -0,0 +1,120 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "alike.h"
+
+/*
+ * Cache of S4 inheritance checks.
+ *
+ * Checking whether an S4 `current` inherits from the class of an S4 `target`
+ * requires evaluating `inherits` in R, which goes through the methods package.
+ * For structures with many S4 objects of the same classes the result is always
+ * the same, so we store it in a small direct mapped table keyed on the class
+ * and package of each of the two objects.
+ *
+ * The keys are stored as a STRSXP holding the four CHARSXPs, which both keeps
+ * them from being garbage collected and allows us to compare keys by pointer
+ * since CHARSXPs are cached by R.
+ *
+ * Entries are stamped with a generation number, and incrementing the
+ * generation invalidates the whole cache.  This is done at the beginning of
+ * each top level `alike` comparison unless the `s4.cache.persist` setting is
+ * TRUE, since class definitions can change between calls.
+ */
+
+#define ALIKEC_S4C_SIZE 64  // must be a power of 2
+
+static SEXP ALIKEC_s4_cache_keys = NULL;
+static int ALIKEC_s4_cache_res[ALIKEC_S4C_SIZE];
+static unsigned int ALIKEC_s4_cache_gen[ALIKEC_S4C_SIZE];
+static unsigned int ALIKEC_s4_cache_gen_cur = 1;
+
+void ALIKEC_s4_cache_reset() {
+  // Generation 0 is never valid, so on wrap around skip it
+
+  if(!++ALIKEC_s4_cache_gen_cur) {
+    ++ALIKEC_s4_cache_gen_cur;
+    for(int i = 0; i < ALIKEC_S4C_SIZE; ++i) ALIKEC_s4_cache_gen[i] = 0;
+  }
+}
+/*
+ * Class and package CHARSXPs of an S4 object, NA_STRING if not available
+ */
+static void ALIKEC_s4_class_pkg(SEXP x, SEXP * klass, SEXP * pkg) {
+  SEXP klass_sxp = getAttrib(x, R_ClassSymbol);
+  *klass = *pkg = NA_STRING;
+  if(TYPEOF(klass_sxp) == STRSXP && XLENGTH(klass_sxp) == 1) {
+    *klass = STRING_ELT(klass_sxp, 0);
+    SEXP pkg_sxp = getAttrib(klass_sxp, ALIKEC_SYM_package);
+    if(TYPEOF(pkg_sxp) == STRSXP && XLENGTH(pkg_sxp) == 1)
+      *pkg = STRING_ELT(pkg_sxp, 0);
+  }
+}
+/*
+ * Whether S4 object `current` inherits from `klass`, the class attribute of
+ * S4 object `target`.
+ */
+int ALIKEC_s4_inherits(SEXP target, SEXP current, SEXP klass) {
+  if(!ALIKEC_s4_cache_keys) {
+    ALIKEC_s4_cache_keys = allocVector(VECSXP, ALIKEC_S4C_SIZE);
+    R_PreserveObject(ALIKEC_s4_cache_keys);
+  }
+  SEXP key[4];
+  ALIKEC_s4_class_pkg(current, key, key + 1);
+  ALIKEC_s4_class_pkg(target, key + 2, key + 3);
+
+  uintptr_t h = 2166136261U;
+  for(int i = 0; i < 4; ++i) h = (h ^ ((uintptr_t) key[i] >> 4)) * 16777619U;
+  R_xlen_t slot_i = (R_xlen_t) ((h ^ (h >> 16)) & (ALIKEC_S4C_SIZE - 1));
+
+  SEXP slot = VECTOR_ELT(ALIKEC_s4_cache_keys, slot_i);
+  if(
+    slot != R_NilValue &&
+    ALIKEC_s4_cache_gen[slot_i] == ALIKEC_s4_cache_gen_cur &&
+    STRING_ELT(slot, 0) == key[0] && STRING_ELT(slot, 1) == key[1] &&
+    STRING_ELT(slot, 2) == key[2] && STRING_ELT(slot, 3) == key[3]
+  )
+    return ALIKEC_s4_cache_res[slot_i];
+
+  // Construct call to `inherits`; we evaluate in base env since class
+  // definitions should still be visible and this way unlikely that
+  // inherits gets overwritten.  Can't use Rf_inherits because that doesn't
+  // work for S4 classes, and we can't figure out a way to access inherits3
+  // from src/main/objects.c directly
+
+  SEXP t, s;
+  t = s = PROTECT(allocList(3));
+  SET_TYPEOF(s, LANGSXP);
+  SETCAR(t, ALIKEC_SYM_inherits); t = CDR(t);
+  SETCAR(t, current); t = CDR(t);
+  SETCAR(t, klass);
+  int inherits = asLogical(PROTECT(eval(s, R_BaseEnv)));
+  UNPROTECT(2);
+
+  // Evaluation could have reset the cache (e.g. via a nested `alike`), which
+  // doesn't matter as the result we're about to store is current
+
+  slot = PROTECT(allocVector(STRSXP, 4));
+  for(int i = 0; i < 4; ++i) SET_STRING_ELT(slot, i, key[i]);
+  SET_VECTOR_ELT(ALIKEC_s4_cache_keys, slot_i, slot);
+  UNPROTECT(1);
+  ALIKEC_s4_cache_res[slot_i] = inherits;
+  ALIKEC_s4_cache_gen[slot_i] = ALIKEC_s4_cache_gen_cur;
+
+  return inherits;
+}
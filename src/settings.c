@@ -29,7 +29,7 @@ struct VALC_settings VALC_settings_init() {
     .attr_mode = 0,
     .lang_mode = 0,
     .fun_mode = 0,
-    .fuzzy_int_max_len = 100,
+    .fuzzy_int_max_len = 100000,
     .suppress_warnings = 0,
     .in_attr = 0,
     .env = R_NilValue,
@@ -40,7 +40,11 @@ struct VALC_settings VALC_settings_init() {
     .symb_size_max = 15000L,
     .track_hash_content_size = 63L,
     .result_list_size_init = 64L,
-    .result_list_size_max = 2048L
+    .result_list_size_max = 2048L,
+    .threads = 1,
+    .thread_min_len = 10000000,
+    .s4_cache_persist = 0,
+    .fast_fail = 0
   };
 }
 /*
@@ -77,6 +81,20 @@ static long VALC_is_scalar_int(
     );
   return x_int;
 }
+/*
+ * Check that a SEXP is TRUE or FALSE and return it as an int
+ */
+static int VALC_is_scalar_lgl(SEXP x, const char * x_name) {
+  if(
+    TYPEOF(x) != LGLSXP || xlength(x) != 1 || asInteger(x) == NA_LOGICAL
+  ) {
+    error(
+      "%s%s%s",
+      "`vet/vetr` usage error: setting `", x_name, "` must be TRUE or FALSE"
+    );
+  }
+  return asLogical(x);
+}
 /*
  * Convert input setting list into settings structure, validating
  * along the way
@@ -87,7 +105,7 @@ static long VALC_is_scalar_int(
 
 struct VALC_settings VALC_settings_vet(SEXP set_list, SEXP env) {
   struct VALC_settings settings = VALC_settings_init();
-  R_xlen_t set_len = 16;
+  R_xlen_t set_len = 20;
 
   if(TYPEOF(set_list) == VECSXP) {
     if(xlength(set_list) != set_len) {
@@ -109,7 +127,8 @@ struct VALC_settings VALC_settings_vet(SEXP set_list, SEXP env) {
       "suppress.warnings", "fuzzy.int.max.len",
       "width", "env.depth.max", "symb.sub.depth.max", "symb.size.max",
       "nchar.max", "track.hash.content.size", "env",
-      "result.list.size.init", "result.list.size.max"
+      "result.list.size.init", "result.list.size.max",
+      "threads", "thread.min.len", "s4.cache.persist", "fast.fail"
     };
     SEXP set_names_def_sxp = PROTECT(allocVector(STRSXP, set_len));
     for(R_xlen_t i = 0; i < set_len; ++i) {
@@ -158,18 +177,8 @@ struct VALC_settings VALC_settings_vet(SEXP set_list, SEXP env) {
     );
     // Other checks
 
-    SEXP sup_warn = VECTOR_ELT(set_list, 5);
-    if(
-      TYPEOF(sup_warn) != LGLSXP || xlength(sup_warn) != 1 ||
-      asInteger(sup_warn) == NA_LOGICAL
-    ) {
-      error(
-        "%s%s",
-        "`vet/vetr` usage error: setting `suppress.warnings` must be TRUE ",
-        "or FALSE"
-      );
-    }
-    settings.suppress_warnings = asLogical(sup_warn);
+    settings.suppress_warnings =
+      VALC_is_scalar_lgl(VECTOR_ELT(set_list, 5), "suppress.warnings");
 
     if(
       TYPEOF(VECTOR_ELT(set_list, 13)) != ENVSXP &&
@@ -189,6 +198,15 @@ struct VALC_settings VALC_settings_vet(SEXP set_list, SEXP env) {
     settings.result_list_size_max = VALC_is_scalar_int(
       VECTOR_ELT(set_list, 15), "result.list.size.max", 1, INT_MAX - 1
     );
+    settings.threads =
+      VALC_is_scalar_int(VECTOR_ELT(set_list, 16), "threads", 1, 1024);
+    settings.thread_min_len = VALC_is_scalar_int(
+      VECTOR_ELT(set_list, 17), "thread.min.len", 0, INT_MAX
+    );
+    settings.s4_cache_persist =
+      VALC_is_scalar_lgl(VECTOR_ELT(set_list, 18), "s4.cache.persist");
+    settings.fast_fail =
+      VALC_is_scalar_lgl(VECTOR_ELT(set_list, 19), "fast.fail");
   } else if (set_list != R_NilValue) {
     error(
       "%s (is %s).",
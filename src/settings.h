@@ -56,6 +56,20 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 
     int result_list_size_init;
     int result_list_size_max;
+
+    // Multi-threading for long vectors (`all_bw`, and list elements in
+    // `alike`)
+
+    int threads;
+    int thread_min_len;
+
+    // Whether to keep the S4 inheritance cache across calls
+
+    int s4_cache_persist;
+
+    // Only report whether objects pass, without the failure message
+
+    int fast_fail;
   };
   struct VALC_settings VALC_settings_init();
   struct VALC_settings VALC_settings_vet(SEXP set_list, SEXP env);
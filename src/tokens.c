@@ -0,0 +1,232 @@
+/*
+Copyright (C) 2020 Brodie Gaslam
+
+This file is part of "vetr - Trust, but Verify"
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
+*/
+
+#include "validate.h"
+#include "all-bw.h"
+#include <limits.h>
+
+/*
+ * Native implementations of the simple predefined tokens.
+ *
+ * Tokens such as `NO.NA` (`!is.na(.)`) would normally be evaluated in R, which
+ * allocates a logical vector as long as the object being vetted, only to have
+ * `VALC_all` scan it.  Instead, when `VALC_parse` sees one of these tokens (by
+ * identity, so user tokens that look the same are not affected) it records a
+ * special parse code, and `VALC_evaluate_recurse` checks the object directly in
+ * a single pass that stops at the first failure.
+ *
+ * We only handle plain (i.e. non-object) vectors of the types below; anything
+ * else falls back to evaluation in R, so the token objects themselves are left
+ * unchanged and keep their "err.msg" attributes for error reporting.
+ */
+
+static SEXP VALC_native_tokens = NULL;
+
+/*
+ * Called from `.onLoad` with the token objects in the order of the
+ * `VALC_TOK_*` codes.
+ */
+SEXP VALC_native_tokens_init(SEXP tokens) {
+  if(
+    TYPEOF(tokens) != VECSXP ||
+    XLENGTH(tokens) != VALC_TOK_NATIVE_MAX - VALC_TOK_NATIVE_MIN + 1
+  )
+    error("Internal Error: bad native token list; contact maintainer."); // nocov
+
+  if(VALC_native_tokens) R_ReleaseObject(VALC_native_tokens);
+  VALC_native_tokens = tokens;
+  R_PreserveObject(VALC_native_tokens);
+  return R_NilValue;
+}
+/*
+ * Return the parse code of the native token `symb` resolves to in `rho`, or 0
+ * if it does not resolve to one.  Meant to be called after `VALC_sub_symbol`
+ * has already resolved (and forced) `symb`.
+ */
+int VALC_native_token_code(SEXP symb, SEXP rho) {
+  if(!VALC_native_tokens || TYPEOF(symb) != SYMSXP) return 0;
+
+  SEXP val = findVar(symb, rho);
+  // Already forced, so this just retrieves the value
+  if(TYPEOF(val) == PROMSXP) val = eval(val, rho);
+  if(TYPEOF(val) != LANGSXP) return 0;
+
+  R_xlen_t tok_len = XLENGTH(VALC_native_tokens);
+  for(R_xlen_t i = 0; i < tok_len; ++i) {
+    if(val == VECTOR_ELT(VALC_native_tokens, i))
+      return VALC_TOK_NATIVE_MIN + (int) i;
+  }
+  return 0;
+}
+/*
+ * The numeric tokens are all range checks, so for ALTREP vectors we can use
+ * the `all_bw` functions that avoid materializing them.
+ *
+ * @return as `VALC_all_bw_real_altrep`
+ */
+static R_xlen_t VALC_native_token_altrep(int code, SEXP x, R_xlen_t len) {
+  if(TYPEOF(x) == REALSXP) {
+    double lo = R_NegInf, hi = R_PosInf;
+    int inc_lo = 1, inc_hi = 1;
+    switch(code) {
+      case VALC_TOK_NO_NA: break;
+      case VALC_TOK_NO_INF: inc_lo = inc_hi = 0; break;
+      case VALC_TOK_GTE_0: lo = 0; break;
+      case VALC_TOK_GT_0: lo = 0; inc_lo = 0; break;
+      case VALC_TOK_LTE_0: hi = 0; break;
+      case VALC_TOK_LT_0: hi = 0; inc_hi = 0; break;
+      default: return -1; // nocov
+    }
+    return VALC_all_bw_real_altrep(x, len, lo, hi, inc_lo, inc_hi, 0);
+  } else if(TYPEOF(x) == INTSXP || TYPEOF(x) == LGLSXP) {
+    // `lo` must be at least INT_MIN + 1, and NA_INTEGER always fails
+    int lo = INT_MIN + 1, hi = INT_MAX;
+    switch(code) {
+      case VALC_TOK_NO_NA:
+      case VALC_TOK_NO_INF: break;
+      case VALC_TOK_GTE_0: lo = 0; break;
+      case VALC_TOK_GT_0: lo = 1; break;
+      case VALC_TOK_LTE_0: hi = 0; break;
+      case VALC_TOK_LT_0: hi = -1; break;
+      default: return -1; // nocov
+    }
+    return VALC_all_bw_int_altrep(x, len, lo, hi, 1, 1, 0);
+  }
+  return -1;
+}
+/*
+ * Check `x` against native token `code`.
+ *
+ * Results mirror what `VALC_all` would make of evaluating the R version of the
+ * token:
+ *
+ * @return 1 if all elements pass, 0 if any fail, -1 if `x` is not something we
+ *   can check natively and the token should be evaluated in R instead.
+ */
+int VALC_native_token_eval(int code, SEXP x) {
+  SEXPTYPE x_type = TYPEOF(x);
+  if(
+    OBJECT(x) || (
+      x_type != LGLSXP && x_type != INTSXP && x_type != REALSXP &&
+      x_type != STRSXP && x_type != CPLXSXP
+  ) )
+    return -1;
+
+  R_xlen_t i, len = XLENGTH(x);
+
+  if(ALTREP(x)) {
+    R_xlen_t fail = VALC_native_token_altrep(code, x, len);
+    if(fail >= 0) return fail == len;
+  }
+
+  switch(x_type) {
+    case LGLSXP:
+    case INTSXP: {
+      int * x_int = x_type == INTSXP ? INTEGER(x) : LOGICAL(x);
+      int success = 1;
+      switch(code) {
+        case VALC_TOK_NO_NA:
+        case VALC_TOK_NO_INF:
+          for(i = 0; i < len; ++i)
+            if(x_int[i] == NA_INTEGER) {success = 0; break;}
+          break;
+        case VALC_TOK_GTE_0:
+          for(i = 0; i < len; ++i)
+            if(x_int[i] == NA_INTEGER || x_int[i] < 0) {success = 0; break;}
+          break;
+        case VALC_TOK_GT_0:
+          for(i = 0; i < len; ++i)
+            if(x_int[i] == NA_INTEGER || x_int[i] <= 0) {success = 0; break;}
+          break;
+        case VALC_TOK_LTE_0:
+          // NA_INTEGER is INT_MIN so must be checked explicitly
+          for(i = 0; i < len; ++i)
+            if(x_int[i] == NA_INTEGER || x_int[i] > 0) {success = 0; break;}
+          break;
+        case VALC_TOK_LT_0:
+          for(i = 0; i < len; ++i)
+            if(x_int[i] == NA_INTEGER || x_int[i] >= 0) {success = 0; break;}
+          break;
+        default: return -1; // nocov
+      }
+      return success;
+    }
+    case REALSXP: {
+      // Comparisons with NaN are false, so writing the tests as "passes" makes
+      // them fail on NA and NaN as R would
+
+      double * x_real = REAL(x);
+      int success = 1;
+      switch(code) {
+        case VALC_TOK_NO_NA:
+          for(i = 0; i < len; ++i)
+            if(ISNAN(x_real[i])) {success = 0; break;}
+          break;
+        case VALC_TOK_NO_INF:
+          for(i = 0; i < len; ++i)
+            if(!R_FINITE(x_real[i])) {success = 0; break;}
+          break;
+        case VALC_TOK_GTE_0:
+          for(i = 0; i < len; ++i)
+            if(!(x_real[i] >= 0)) {success = 0; break;}
+          break;
+        case VALC_TOK_GT_0:
+          for(i = 0; i < len; ++i)
+            if(!(x_real[i] > 0)) {success = 0; break;}
+          break;
+        case VALC_TOK_LTE_0:
+          for(i = 0; i < len; ++i)
+            if(!(x_real[i] <= 0)) {success = 0; break;}
+          break;
+        case VALC_TOK_LT_0:
+          for(i = 0; i < len; ++i)
+            if(!(x_real[i] < 0)) {success = 0; break;}
+          break;
+        default: return -1; // nocov
+      }
+      return success;
+    }
+    case STRSXP: {
+      // `is.finite` is always FALSE for strings; comparisons are locale
+      // dependent so we leave them to R
+
+      if(code == VALC_TOK_NO_NA) {
+        if(STRING_NO_NA(x)) return 1;
+        for(i = 0; i < len; ++i) if(STRING_ELT(x, i) == NA_STRING) return 0;
+        return 1;
+      } else if(code == VALC_TOK_NO_INF) {
+        return !len;
+      }
+      return -1;
+    }
+    case CPLXSXP: {
+      Rcomplex * x_cplx = COMPLEX(x);
+      if(code == VALC_TOK_NO_NA) {
+        for(i = 0; i < len; ++i)
+          if(ISNAN(x_cplx[i].r) || ISNAN(x_cplx[i].i)) return 0;
+        return 1;
+      } else if(code == VALC_TOK_NO_INF) {
+        for(i = 0; i < len; ++i)
+          if(!R_FINITE(x_cplx[i].r) || !R_FINITE(x_cplx[i].i)) return 0;
+        return 1;
+      }
+      return -1;
+    }
+  }
+  return -1;
+}
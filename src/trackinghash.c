@@ -16,7 +16,6 @@ GNU General Public License for more details.
 Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 */
 
-#include "pfhash.h"
 #include "cstringr.h"
 #include "trackinghash.h"
 
@@ -29,8 +28,9 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
  * has no effect on the actual hash table.
  */
 struct track_hash * VALC_create_track_hash(size_t size_init) {
-  pfHashTable * hash = pfHashCreate(NULL);
-  char ** contents = (char **) R_alloc(size_init, sizeof(char *));
+  struct VALC_ptr_hash * hash = VALC_ptr_hash_create(size_init);
+  const void ** contents =
+    (const void **) R_alloc(size_init, sizeof(const void *));
   struct track_hash * track_hash =
     (struct track_hash *) R_alloc(1, sizeof(struct track_hash));
 
@@ -56,12 +56,12 @@ void VALC_reset_track_hash(
 ) {
   for(size_t i = track_hash->idx; i > idx; --i) {
 
-    int del_res = pfHashDel(track_hash->hash, track_hash->contents[i - 1]);
+    int del_res =
+      VALC_ptr_hash_del(track_hash->hash, track_hash->contents[i - 1]);
     if(del_res)
       // nocov start
       error(
-        "Internal Error: unable to delete key %s; contact maintainer.",
-        track_hash->contents[i - 1]
+        "Internal Error: unable to delete key %zu; contact maintainer.", i - 1
       );
       // nocov end
   }
@@ -76,19 +76,12 @@ void VALC_reset_track_hash(
  */
 
 int VALC_add_to_track_hash(
-  struct track_hash * track_hash, const char * key, const char * value,
-  size_t max_nchar
+  struct track_hash * track_hash, const void * key
 ) {
   int res = 1;
-  int res_set = pfHashSet(track_hash->hash, key, value);
-
-  if(res_set < 0) {
-    // nocov start
-    error(
-      "Internal Error: failed setting value in hash table, contact maintainer."
-    );
-    // nocov end
-  } else if(res_set) {
+  int res_set = VALC_ptr_hash_set(track_hash->hash, key, key);
+
+  if(res_set) {
     // Already existed, so no need to add
     res = 0;
   } else {
@@ -112,13 +105,13 @@ int VALC_add_to_track_hash(
         );
         // nocov end
       }
-      // re-allocate, note that we are re-allocating an array of pointers to
-      // strings, but `S_realloc` is looking for a (char *) hence the coersion
+      // re-allocate, note that we are re-allocating an array of pointers,
+      // but `S_realloc` is looking for a (char *) hence the coersion
 
-      track_hash->contents = (char **) S_realloc(
+      track_hash->contents = (const void **) S_realloc(
         (char *) track_hash->contents, (long) new_size,
         (long) track_hash->idx_max,
-        sizeof(char *)
+        sizeof(const void *)
       );
       res = (int) new_size;
       track_hash->idx_max = new_size;
@@ -127,13 +120,9 @@ int VALC_add_to_track_hash(
       error("Internal Error: hash index corrupted; contact maintainer.");
       // nocov end
     }
-    // We incur some cost in duplicating string here which may not be strictly
-    // necessary since it's most likely every string we use here should be
-    // present for the duration of execution, but cost is probably reasonably
-    // low.  Should revisit if this turns out to be wrong.
+    // Keys are interned R objects that outlive the hash, so no need to copy
 
-    char * key_cpy = CSR_strmcpy(key, max_nchar);
-    track_hash->contents[track_hash->idx] = key_cpy;
+    track_hash->contents[track_hash->idx] = key;
     track_hash->idx++;  // shouldn't be overflowable
   }
   return res;
@@ -160,7 +149,6 @@ SEXP VALC_track_hash_test(SEXP keys, SEXP size) {
   SEXP res = PROTECT(allocVector(INTSXP, key_size));
 
   struct track_hash * track_hash = VALC_create_track_hash(asInteger(size));
-  struct VALC_settings set = VALC_settings_init();
 
   for(i = 0; i < key_size; ++i) {
     if(STRING_ELT(keys, i) == NA_STRING) {
@@ -172,9 +160,8 @@ SEXP VALC_track_hash_test(SEXP keys, SEXP size) {
         INTEGER(res)[i] = reset_int;
       }
     } else {
-      int add_res = VALC_add_to_track_hash(
-        track_hash, CHAR(STRING_ELT(keys, i)), "42", set.nchar_max
-      );
+      // CHARSXPs are cached so the same string is always the same pointer
+      int add_res = VALC_add_to_track_hash(track_hash, STRING_ELT(keys, i));
       INTEGER(res)[i] = add_res;
     }
   }
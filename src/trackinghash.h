@@ -17,7 +17,7 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 */
 
 #include "cstringr.h"
-#include "pfhash.h"
+#include "ptrhash.h"
 #include "settings.h"
 
 #ifndef _TRACK_HASH_H
@@ -25,19 +25,19 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 
   /*
    * Note: last value written to `contents` is at ->idx - 1, if ->idx is zero,
-   * then the list is empty
+   * then the list is empty.  Keys are pointers to interned R objects (e.g.
+   * SYMSXPs), see ptrhash.c
    */
 
   struct track_hash {
-    pfHashTable * hash;
-    char ** contents;          // an array of characters
+    struct VALC_ptr_hash * hash;
+    const void ** contents;    // an array of the keys, in insertion order
     size_t idx;                // location after last value in contents
     size_t idx_max;            // how big the contents are
   };
   struct track_hash * VALC_create_track_hash(size_t size_init);
   int VALC_add_to_track_hash(
-    struct track_hash * track_hash, const char * key, const char * value,
-    size_t max_nchar
+    struct track_hash * track_hash, const void * key
   );
   void VALC_reset_track_hash(
     struct track_hash * track_hash, size_t idx
@@ -17,6 +17,7 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
 */
 
 #include "alike.h"
+#include "all-bw.h"
 
 /*
 compare types, accounting for "integer like" numerics; empty string means
@@ -109,29 +110,12 @@ SEXP ALIKEC_type_alike(
 /* - typeof ----------------------------------------------------------------- */
 
 SEXPTYPE ALIKEC_typeof_internal(SEXP object) {
-  double * obj_real;
   SEXPTYPE obj_type = TYPEOF(object);
 
   switch(obj_type) {
     case REALSXP:
-      {
-        R_xlen_t obj_len = XLENGTH(object), i;
-        obj_real = REAL(object);
-        /*
-        could optimize this more by using the magic number tricks or bit
-        fiddling, but at end of day this still wouldn't be fast enough to
-        realistically use on a very large vector, so it doesn't really matter
-        */
-        for(i = 0; i < obj_len; i++) {
-          if(
-            (isnan(obj_real[i]) || !isfinite(obj_real[i])) ||
-            obj_real[i] != (int)obj_real[i]
-          )
-            return REALSXP;
-        }
-        return INTSXP;
-      }
-      break;
+      // vectorized, see all-bw-simd.c
+      return VALC_all_int_like(object) ? INTSXP : REALSXP;
     case CLOSXP:
     case BUILTINSXP:
     case SPECIALSXP:
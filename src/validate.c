@@ -141,22 +141,16 @@ SEXP VALC_process_error(
 
   if(!xlength(val_res)) return VALC_TRUE;
 
-  // Compose optional argument part of message. This ends up being "Argument
-  // `x` should %s" where arg and should are optional
-
-  char * err_arg_msg = "";
-  const char * err_arg = CHAR(PRINTNAME(val_tag));
-  const char * err_very_base = "For argument `%s`%s%s%s";
+  // Compose optional argument part of message. This ends up being "For
+  // argument `x`", and is followed by the interim and message parts
 
+  struct CSR_strbuf err_base;
+  CSR_strbuf_init(&err_base, 0, set.nchar_max);
   if(ret_mode == 1) {
-    err_arg_msg = CSR_smprintf4(
-      set.nchar_max, err_very_base, err_arg, "", "", ""
-    );
+    CSR_strbuf_add(&err_base, "For argument `");
+    CSR_strbuf_add(&err_base, CHAR(PRINTNAME(val_tag)));
+    CSR_strbuf_add(&err_base, "`");
   }
-  const char * err_base = "%s%%s%%s%s%s%s";
-  char * err_base_msg = CSR_smprintf4(
-    set.nchar_max, err_base, err_arg_msg, "", "", ""
-  );
   // Collapse similar entries into one; from this point on every entry in the
   // list should be a character(1L)
 
@@ -208,17 +202,12 @@ SEXP VALC_process_error(
       // Here we need to compose the full character value since there is only
       // one correct value for the arg
 
-      const char * err_msg_orig = CHAR(asChar(err_vec_res));
-      char * err_msg = CSR_strmcpy(err_msg_orig, set.nchar_max);
-      if(err_msg) err_msg[0] = tolower(err_msg[0]);
-
-      const char * err_interim = "";
-      if(ret_mode == 1) err_interim = ", ";
+      if(ret_mode == 1) CSR_strbuf_add(&err_base, ", ");
+      size_t msg_start = err_base.len;
+      CSR_strbuf_add(&err_base, CHAR(asChar(err_vec_res)));
+      err_base.buf[msg_start] = tolower(err_base.buf[msg_start]);
 
-      char * err_full = CSR_smprintf4(
-        set.nchar_max, err_base_msg, err_interim, err_msg, "", ""
-      );
-      SET_STRING_ELT(err_vec_res, 0, mkChar(err_full));
+      SET_STRING_ELT(err_vec_res, 0, mkChar(err_base.buf));
     } else if(has_header) {
       // Have multiple "or" cases
 
@@ -228,10 +217,8 @@ SEXP VALC_process_error(
       } else if(!ret_mode) {
         err_interim = "At least one of these should pass:";
       }
-      char * err_head = CSR_smprintf4(
-        set.nchar_max, err_base_msg, err_interim, "", "", ""
-      );
-      SET_STRING_ELT(err_vec_res, 0, mkChar(err_head));
+      CSR_strbuf_add(&err_base, err_interim);
+      SET_STRING_ELT(err_vec_res, 0, mkChar(err_base.buf));
     }
   }
   UNPROTECT(4);  // unprotects vector result
@@ -250,11 +237,11 @@ SEXP VALC_process_error(
 /* -------------------------------------------------------------------------- *\
 \* -------------------------------------------------------------------------- */
 
-SEXP VALC_validate(
-  SEXP target, SEXP current, SEXP cur_sub, SEXP par_call, SEXP rho,
-  SEXP ret_mode_sxp, SEXP stop, SEXP settings
-) {
-  SEXP res;
+/*
+ * Check the `vet` arguments that do not depend on outcome, returns `stop` as
+ * an int.
+ */
+static int VALC_validate_check_args(SEXP ret_mode_sxp, SEXP stop, SEXP rho) {
   if(TYPEOF(ret_mode_sxp) != STRSXP && XLENGTH(ret_mode_sxp) != 1)
     error("`vet` usage error: argument `format` must be character(1L).");
   int stop_int;
@@ -270,19 +257,9 @@ SEXP VALC_validate(
       "`vet` usage error: argument `env` must be an environment (is %s).",
       type2char(TYPEOF(rho))
     );
-
-  struct VALC_settings set = VALC_settings_vet(settings, rho);
-  res = PROTECT(
-    VALC_evaluate(
-      target, cur_sub,
-      TYPEOF(cur_sub) == SYMSXP ? cur_sub : VALC_SYM_current,
-      current, par_call, set, 1
-    )
-  );
-  if(!xlength(res)) {
-    UNPROTECT(1);
-    return(ScalarLogical(1));
-  }
+  return stop_int;
+}
+static int VALC_validate_ret_mode(SEXP ret_mode_sxp) {
   const char * ret_mode_chr = CHAR(asChar(ret_mode_sxp));
   int ret_mode;
 
@@ -298,6 +275,29 @@ SEXP VALC_validate(
       "`vet` usage error: argument `format` must be one of \"text\", \"raw\", ",
       "\"full\""
     );
+  return ret_mode;
+}
+SEXP VALC_validate(
+  SEXP target, SEXP current, SEXP cur_sub, SEXP par_call, SEXP rho,
+  SEXP ret_mode_sxp, SEXP stop, SEXP settings
+) {
+  SEXP res;
+  int stop_int = VALC_validate_check_args(ret_mode_sxp, stop, rho);
+
+  struct VALC_settings set = VALC_settings_vet(settings, rho);
+  if(stop_int) set.fast_fail = 0;  // need the message for the error
+  res = PROTECT(
+    VALC_evaluate(
+      target, cur_sub,
+      TYPEOF(cur_sub) == SYMSXP ? cur_sub : VALC_SYM_current,
+      current, par_call, set, 1
+    )
+  );
+  if(!xlength(res) || set.fast_fail) {
+    UNPROTECT(1);
+    return(ScalarLogical(!xlength(res)));
+  }
+  int ret_mode = VALC_validate_ret_mode(ret_mode_sxp);
 
   SEXP out = VALC_process_error(
     res, VALC_SYM_current, par_call, ret_mode, stop_int, set
@@ -305,6 +305,94 @@ SEXP VALC_validate(
   UNPROTECT(1);
   return out;
 }
+/*
+ * Equivalent to `new.env(FALSE, parent)`
+ */
+static SEXP VALC_new_env(SEXP parent) {
+  SEXP call = PROTECT(
+    lang3(install("new.env"), PROTECT(ScalarLogical(0)), parent)
+  );
+  SEXP env = eval(call, R_BaseEnv);
+  UNPROTECT(2);
+  return env;
+}
+/*
+ * Vet each element of list `current` against `target`
+ *
+ * The settings are vetted once, and every element is vetted with the same
+ * substituted vetting expression so that it is parsed only once (see
+ * parse-cache.c).  To do so we bind the element to `cur_sub` (or `current` if
+ * `cur_sub` is not a symbol) in a child environment of the evaluation
+ * environment.  This would produce error messages that refer to the whole
+ * object instead of the element, so for the (hopefully few) elements that fail
+ * we vet again as `cur_sub[[i]]` to generate the error message.
+ *
+ * @return a list as long as `current` with, for each element, whatever `vet`
+ *   would have returned for it.
+ */
+SEXP VALC_validate_each(
+  SEXP target, SEXP current, SEXP cur_sub, SEXP par_call, SEXP rho,
+  SEXP ret_mode_sxp, SEXP stop, SEXP settings
+) {
+  int stop_int = VALC_validate_check_args(ret_mode_sxp, stop, rho);
+  if(TYPEOF(current) != VECSXP)
+    error(
+      "`vet_each` usage error: argument `current` must be a list (is %s).",
+      type2char(TYPEOF(current))
+    );
+
+  struct VALC_settings set = VALC_settings_vet(settings, rho);
+  if(stop_int) set.fast_fail = 0;  // need the message for the error
+  SEXP cur_symb = TYPEOF(cur_sub) == SYMSXP ? cur_sub : VALC_SYM_current;
+
+  SEXP elt_env = PROTECT(VALC_new_env(set.env));
+  SEXP all_env = PROTECT(VALC_new_env(set.env));
+  defineVar(cur_symb, current, all_env);
+
+  R_xlen_t cur_len = XLENGTH(current);
+  SEXP out = PROTECT(allocVector(VECSXP, cur_len));
+  SEXP out_true = PROTECT(ScalarLogical(1));
+  SEXP out_false = PROTECT(ScalarLogical(0));
+  int ret_mode = -1;
+
+  for(R_xlen_t i = 0; i < cur_len; ++i) {
+    // Results are fully converted to SEXP, so release scratch memory between
+    // elements
+    const void * vmax = vmaxget();
+    SEXP cur_elt = VECTOR_ELT(current, i);
+    defineVar(cur_symb, cur_elt, elt_env);
+    set.env = elt_env;
+    SEXP res = VALC_evaluate(
+      target, cur_symb, cur_symb, cur_elt, par_call, set, 1
+    );
+    if(!xlength(res) || set.fast_fail) {
+      SET_VECTOR_ELT(out, i, xlength(res) ? out_false : out_true);
+      vmaxset(vmax);
+      continue;
+    }
+    // Failure, re-vet to generate the error message
+
+    if(ret_mode < 0) ret_mode = VALC_validate_ret_mode(ret_mode_sxp);
+    SEXP cur_sub_i = PROTECT(
+      lang3(R_Bracket2Symbol, cur_symb, PROTECT(ScalarReal((double) i + 1)))
+    );
+    set.env = all_env;
+    res = PROTECT(
+      VALC_evaluate(target, cur_sub_i, cur_symb, cur_elt, par_call, set, 1)
+    );
+    SET_VECTOR_ELT(
+      out, i,
+      VALC_process_error(
+        res, VALC_SYM_current, par_call, ret_mode, stop_int, set
+      )
+    );
+    UNPROTECT(3);
+    vmaxset(vmax);
+  }
+  setAttrib(out, R_NamesSymbol, getAttrib(current, R_NamesSymbol));
+  UNPROTECT(5);
+  return out;
+}
 
 /* -------------------------------------------------------------------------- *\
 \* -------------------------------------------------------------------------- */
@@ -316,6 +404,7 @@ SEXP VALC_validate_args(
 
   struct VALC_settings set = VALC_settings_vet(settings, fun_frame);
   set.env = fun_frame;
+  set.fast_fail = 0;  // failures are always errors, so need the message
 
   // For the elements with validation call setup, check for errors;  Note that
   // we need to skip the first element of the calls since we only care about the
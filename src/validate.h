@@ -77,6 +77,26 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
     int idx_alloc_max;// max we are allowed to allocate
   };
 
+  // Parse codes for predefined tokens with native implementations (see
+  // tokens.c); these must remain contiguous and in the same order as the token
+  // list provided in `.onLoad`
+
+  #define VALC_TOK_NO_NA 20
+  #define VALC_TOK_NO_INF 21
+  #define VALC_TOK_GTE_0 22
+  #define VALC_TOK_GT_0 23
+  #define VALC_TOK_LTE_0 24
+  #define VALC_TOK_LT_0 25
+  #define VALC_TOK_NATIVE_MIN VALC_TOK_NO_NA
+  #define VALC_TOK_NATIVE_MAX VALC_TOK_LT_0
+
+  // Dispatch hints for `||` chains of templates (see `VALC_or_tpl_index`);
+  // hints hold the SEXPTYPE of the last value of each template, or one of these
+
+  #define VALC_OR_TPL_MIN 4       // min alternatives to build a table for
+  #define VALC_OR_KEY_UNKNOWN -1  // template not evaluated yet
+  #define VALC_OR_KEY_ANY -2      // could match anything (e.g. S4)
+
   extern SEXP VALC_SYM_one_dot;
   extern SEXP VALC_SYM_deparse;
   extern SEXP VALC_SYM_paren;
@@ -84,6 +104,7 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   extern SEXP VALC_SYM_current;
   extern SEXP VALC_TRUE;
   extern SEXP VALC_SYM_errmsg;
+  extern SEXP VALC_SYM_or_tpl;
 
   SEXP VALC_test1(SEXP a);
   SEXP VALC_test2(SEXP a, SEXP b);
@@ -101,6 +122,10 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
     SEXP target, SEXP current, SEXP cur_sub, SEXP par_call, SEXP rho,
     SEXP ret_mode_sxp, SEXP stop, SEXP settings
   );
+  SEXP VALC_validate_each(
+    SEXP target, SEXP current, SEXP cur_sub, SEXP par_call, SEXP rho,
+    SEXP ret_mode_sxp, SEXP stop, SEXP settings
+  );
   SEXP VALC_validate_args(
     SEXP fun, SEXP fun_call, SEXP val_call, SEXP fun_frame, SEXP settings
   );
@@ -115,16 +140,23 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
   SEXP VALC_parse(
     SEXP lang, SEXP var_name, struct VALC_settings settings, SEXP arg_tag
   );
+  SEXP VALC_parse_int(
+    SEXP lang, SEXP var_name, struct VALC_settings settings, SEXP arg_tag,
+    SEXP deps, int native
+  );
   SEXP VALC_parse_ext(SEXP lang, SEXP var_name, SEXP rho);
+  SEXP VALC_parse_cached(
+    SEXP lang, SEXP var_name, struct VALC_settings set, SEXP arg_tag
+  );
   void VALC_parse_recurse(
     SEXP lang, SEXP lang2, SEXP lang_track, SEXP var_name, int eval_as_is,
     SEXP first_fun, struct VALC_settings set,
     struct track_hash * track_hash, struct track_hash * track_hash2,
-    SEXP arg_tag
+    SEXP arg_tag, SEXP deps, int native
   );
   SEXP VALC_sub_symbol(
     SEXP lang, struct VALC_settings set, struct track_hash * track_hash,
-    SEXP arg_tag
+    SEXP arg_tag, SEXP deps
   );
   SEXP VALC_sub_symbol_ext(SEXP lang, SEXP rho);
   void VALC_install_objs();
@@ -137,5 +169,8 @@ Go to <https://www.r-project.org/Licenses/GPL-2> for a copy of the license.
     SEXP rho
   );
   void VALC_arg_error(SEXP tag, SEXP fun_call, const char * err_base);
+  SEXP VALC_native_tokens_init(SEXP tokens);
+  int VALC_native_token_code(SEXP symb, SEXP rho);
+  int VALC_native_token_eval(int code, SEXP x);
   void psh(const char * lab);
 #endif